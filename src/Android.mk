@@ -13,6 +13,8 @@ LOCAL_CPPFLAGS  := -std=gnu++11 -D STAR2D=1 -D LOGGER_MIN_LEVEL=1 -Ilibs\freetyp
 LOCAL_SRC_FILES := $(call LS_CPP,$(LOCAL_PATH))
 
 LOCAL_STATIC_LIBRARIES := android_native_app_glue freetype libpng
+#zlib is used to inflate compressed Tiled layers
+LOCAL_EXPORT_LDLIBS := -lz
 
 include $(BUILD_STATIC_LIBRARY)
 
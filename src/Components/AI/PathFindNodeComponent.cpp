@@ -27,4 +27,9 @@ namespace star
 	void PathFindNodeComponent::Draw()
 	{
 	}
+
+	CullingBoundsType PathFindNodeComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::None;
+	}
 }
@@ -15,6 +15,7 @@ namespace star
 
 		void Update(const Context& context);
 		void Draw();
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 	protected:
 		void InitializeComponent();
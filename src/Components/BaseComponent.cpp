@@ -44,6 +44,10 @@ namespace star
 		}
 		m_bInitialized = true;
 		InitializeComponent();
+		if(m_pParentObject != nullptr)
+		{
+			m_pParentObject->MarkCullingBoundsDirty();
+		}
 	}
 
 	void BaseComponent::BaseUpdate(const Context& context)
@@ -97,6 +101,11 @@ namespace star
 		return false;
 	}
 
+	CullingBoundsType BaseComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::Unbounded;
+	}
+
 	void BaseComponent::SetEnabled(bool bEnabled)
 	{
 		m_bIsEnabled = bEnabled;
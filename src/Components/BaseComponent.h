@@ -9,6 +9,20 @@ namespace star
 	class TransformComponent;
 	class Object;
 
+	/// <summary>
+	/// Result of GetCullingBounds, tells the spatial index of the scene
+	/// how a component or object takes part in culling.
+	/// </summary>
+	enum class CullingBoundsType : byte
+	{
+		//Never passes the culling check, like the default CheckCulling
+		None,
+		//Only passes the culling check when its bounds are in view
+		Bounds,
+		//Has to be checked every frame, like HUD elements
+		Unbounded
+	};
+
 	/// <summary>
 	/// Base class for all other components. 
 	/// Manages all general functionality and intergration with <see cref="Object"/>s.
@@ -99,6 +113,15 @@ namespace star
 			float32 top,
 			float32 bottom
 			) const;
+		/// <summary>
+		/// Gets the world rectangle this component is culled with.
+		/// By default the component is unbounded and always goes through
+		/// CheckCulling. Override it to return a rectangle, or None when
+		/// CheckCulling never passes, to let the scene skip the component.
+		/// </summary>
+		/// <param name="bounds">Output parameter: left, bottom, right, top.</param>
+		/// <returns>How the component takes part in culling.</returns>
+		virtual CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 		/// <summary>
 		/// Sets the component enabled or disabled.
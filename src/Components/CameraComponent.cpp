@@ -8,6 +8,7 @@
 #include "../Helpers/Math.h"
 #include "../Objects/BaseCamera.h"
 #include "../Graphics/ScaleSystem.h"
+#include "../TimeManager.h"
 
 namespace star
 {
@@ -16,6 +17,9 @@ namespace star
 		m_Projection(),
 		m_View(),
 		m_ViewInverse(),
+		m_PreviousView(),
+		m_PreviousStep(0),
+		m_bHasView(false),
 		m_FarPlane(100.0f),
 		m_NearPlane(0.1f),
 		m_FOV(static_cast<float32>(PI/4.0f)),
@@ -112,8 +116,21 @@ namespace star
 		lookAtVec = vec3(vLookTemp.x, vLookTemp.y, vLookTemp.z);
 		upVec = vec3(vUpVecTemp.x, vUpVecTemp.y, vUpVecTemp.z);
 
+		uint64 step = TimeManager::GetInstance()->GetStepCount();
+		if(m_PreviousStep != step)
+		{
+			m_PreviousView = m_View;
+			m_PreviousStep = step;
+		}
+
 		//Calculate the viewmatrix and inverse
 		m_View = MatrixLookAt(eyeVec, (eyeVec + lookAtVec), upVec);
+		//Don't blend in from the identity
+		if(!m_bHasView)
+		{
+			m_PreviousView = m_View;
+			m_bHasView = true;
+		}
 		m_ViewInverse = Transpose(m_View);
 	}
 
@@ -204,6 +221,20 @@ namespace star
 		return m_ViewInverse;
 	}
 
+	mat4 CameraComponent::GetInterpolatedViewInverse() const
+	{
+		const TimeManager* time = TimeManager::GetInstance();
+		float32 alpha = time->GetInterpolationAlpha();
+		if(alpha >= 1.0f || m_PreviousStep != time->GetStepCount())
+		{
+			return m_ViewInverse;
+		}
+		//Blended as placements of the camera, so the eye moves in a straight line
+		mat4 camera = InterpolateAffine2D(
+			Inverse(m_PreviousView), Inverse(m_View), vec2(), alpha);
+		return Transpose(Inverse(camera));
+	}
+
 	mat4 CameraComponent::GetProjectionViewInverse() const
 	{
 		return m_Projection * m_ViewInverse;
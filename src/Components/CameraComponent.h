@@ -29,6 +29,9 @@ namespace star
 		const mat4 & GetView() const;
 		const mat4 & GetProjection() const;
 		const mat4 & GetViewInverse() const;
+		//Blended between the last two steps like
+		//TransformComponent::GetInterpolatedWorldMatrix
+		mat4 GetInterpolatedViewInverse() const;
 		mat4 GetProjectionViewInverse() const;
 
 		void Translate(const vec2& translation);
@@ -48,7 +51,10 @@ namespace star
 
 		mat4	m_Projection,
 				m_View,
-				m_ViewInverse;
+				m_ViewInverse,
+				m_PreviousView;
+		uint64 m_PreviousStep;
+		bool m_bHasView;
 
 		float32	m_FarPlane,
 				m_NearPlane,
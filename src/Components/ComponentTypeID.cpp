@@ -0,0 +1,31 @@
+#include "ComponentTypeID.h"
+#include "BaseComponent.h"
+
+namespace star
+{
+	uint32 ComponentTypeID::Get(const BaseComponent* component)
+	{
+		return Register(typeid(*component));
+	}
+
+	uint32 ComponentTypeID::Register(const std::type_info& type)
+	{
+		auto& registry = GetRegistry();
+		auto it = registry.find(std::type_index(type));
+		if(it != registry.end())
+		{
+			return it->second;
+		}
+
+		uint32 id = static_cast<uint32>(registry.size());
+		registry[std::type_index(type)] = id;
+		return id;
+	}
+
+	std::unordered_map<std::type_index, uint32>& ComponentTypeID::GetRegistry()
+	{
+		//Constructed on first use, IDs can be requested during static initialization
+		static std::unordered_map<std::type_index, uint32> registry;
+		return registry;
+	}
+}
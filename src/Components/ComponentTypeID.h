@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../defines.h"
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+
+namespace star
+{
+	class BaseComponent;
+
+	//[NOTE]	Hands out small, dense IDs per component type.
+	//			Object uses them as index in its table of component slots.
+	//			Get<T> looks up the ID of a type once and caches it,
+	//			after that it's a plain read without RTTI.
+	//			The registry is keyed on typeid on purpose, like the lookups
+	//			it replaced in Object. Components, user ones included,
+	//			need no macro or base class to get an ID, and the dynamic
+	//			type of an added component can't be known without it.
+	//			Not thread-safe: the registry isn't locked and VS2013 has
+	//			no thread-safe function statics, so the static ID in Get<T>
+	//			could be registered twice. Only call it on the main thread.
+	class ComponentTypeID final
+	{
+	public:
+		template <typename T>
+		static uint32 Get();
+		//ID of the dynamic type of the component,
+		//only used when components are added or removed.
+		static uint32 Get(const BaseComponent* component);
+
+	private:
+		static uint32 Register(const std::type_info& type);
+		static std::unordered_map<std::type_index, uint32>& GetRegistry();
+
+		ComponentTypeID();
+		~ComponentTypeID();
+
+		ComponentTypeID(const ComponentTypeID& yRef);
+		ComponentTypeID(ComponentTypeID&& yRef);
+		ComponentTypeID& operator=(const ComponentTypeID& yRef);
+		ComponentTypeID& operator=(ComponentTypeID&& yRef);
+	};
+
+	template <typename T>
+	uint32 ComponentTypeID::Get()
+	{
+		static const uint32 id = Register(typeid(T));
+		return id;
+	}
+}
@@ -3,6 +3,7 @@
 #include "../../Graphics/SpriteBatch.h"
 #include "SpriteSheetComponent.h"
 #include "TextComponent.h"
+#include <algorithm>
 
 namespace star
 {
@@ -20,8 +21,13 @@ namespace star
 		, m_FilePath(filepath)
 		, m_SpriteName(spriteName)
 		, m_SpriteInfo(nullptr)
+		, m_UVCoords()
+		, m_UVRegion(0, 0, 1, 1)
+		, m_bTexturePending(false)
+		, m_TextureHandle()
 	{
 		m_SpriteInfo = new SpriteInfo();
+		MarkSpriteInfoChanged();
 	}
 
 	void SpriteComponent::InitializeComponent()
@@ -41,6 +47,7 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 				m_FilePath.GetFullPath(),
 				m_SpriteName
 				);
+			m_TextureHandle = TextureManager::GetInstance()->GetTextureHandle(m_SpriteName);
 
 			m_Dimensions.x = TextureManager::GetInstance()->
 				GetTextureDimensions(m_SpriteName).x /
@@ -58,9 +65,24 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 
 	void SpriteComponent::FillSpriteInfo()
 	{
-		m_SpriteInfo->textureID = 
-			TextureManager::GetInstance()->GetTextureID(m_SpriteName);
-		m_SpriteInfo->vertices = vec2(m_Dimensions.x, m_Dimensions.y);
+		m_bTexturePending = TextureManager::GetInstance()->IsTextureLoading(m_SpriteName);
+		uint32 textureID = TextureManager::GetInstance()->GetTextureID(m_SpriteName);
+		vec2 vertices(m_Dimensions.x, m_Dimensions.y);
+		if(textureID != m_SpriteInfo->textureID || vertices != m_SpriteInfo->vertices)
+		{
+			m_SpriteInfo->textureID = textureID;
+			m_SpriteInfo->vertices = vertices;
+			MarkSpriteInfoChanged();
+		}
+
+		//When the texture is packed in an atlas, 
+		//the uvs have to be remapped to its region in the atlas page.
+		vec4 region = TextureManager::GetInstance()->GetTextureUVRegion(m_SpriteName);
+		if(region != m_UVRegion)
+		{
+			m_UVRegion = region;
+			SetUVCoords(m_UVCoords);
+		}
 	}
 
 	SpriteComponent::~SpriteComponent()
@@ -84,7 +106,35 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 
 	void SpriteComponent::SetUVCoords(const vec4& coords)
 	{
-		m_SpriteInfo->uvCoords = coords;
+		m_UVCoords = coords;
+		vec4 uvCoords(
+			m_UVRegion.x + coords.x * m_UVRegion.z,
+			m_UVRegion.y + coords.y * m_UVRegion.w,
+			coords.z * m_UVRegion.z,
+			coords.w * m_UVRegion.w
+			);
+		if(uvCoords != m_SpriteInfo->uvCoords)
+		{
+			m_SpriteInfo->uvCoords = uvCoords;
+			MarkSpriteInfoChanged();
+		}
+	}
+
+	void SpriteComponent::MarkSpriteInfoChanged()
+	{
+		m_SpriteInfo->version = GenerateSpriteInfoVersion();
+		if(m_pParentObject != nullptr)
+		{
+			m_pParentObject->MarkCullingBoundsDirty();
+		}
+	}
+
+	uint32 SpriteComponent::GenerateSpriteInfoVersion()
+	{
+		//Versions are unique over all sprites, so a new SpriteInfo 
+		//can never be mistaken for a cached one at the same address.
+		static uint32 version(0);
+		return ++version;
 	}
 
 	void SpriteComponent::Draw()
@@ -98,6 +148,14 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 		//[COMMENT] Temp hotfix!
 #ifdef ANDROID
 		FillSpriteInfo();
+#else
+		//Swap the placeholder for the real texture once it's uploaded,
+		//or pick up the new one when the texture got reloaded.
+		if(m_bTexturePending
+			|| m_TextureHandle.GetTextureID() != m_SpriteInfo->textureID)
+		{
+			FillSpriteInfo();
+		}
 #endif
 	}
 	
@@ -108,8 +166,9 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 		float bottom
 		) const
 	{
-		//Always draw hudObjects
-		if(m_SpriteInfo->bIsHud)
+		//Always draw hudObjects and static sprites,
+		//the latter are drawn from a cached buffer anyway.
+		if(m_SpriteInfo->bIsHud || m_SpriteInfo->bIsStatic)
 		{
 			return true;
 		}
@@ -135,6 +194,27 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 			(objectPos.y <= top && objTop >= bottom);
 	}
 
+	CullingBoundsType SpriteComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		if(m_SpriteInfo->bIsHud || m_SpriteInfo->bIsStatic)
+		{
+			return CullingBoundsType::Unbounded;
+		}
+
+		pos objectPos = GetTransform()->GetWorldPosition();
+		float32 objRight = objectPos.x + 
+			float32(GetWidth()) * GetTransform()->GetWorldScale().x;
+		float32 objTop = objectPos.y + 
+			float32(GetHeight()) * GetTransform()->GetWorldScale().y;
+
+		//Mirrored sprites have a negative scale
+		bounds.x = std::min(objectPos.x, objRight);
+		bounds.y = std::min(objectPos.y, objTop);
+		bounds.z = std::max(objectPos.x, objRight);
+		bounds.w = std::max(objectPos.y, objTop);
+		return CullingBoundsType::Bounds;
+	}
+
 	const tstring& SpriteComponent::GetFilePath() const
 	{
 		return m_FilePath.GetPath();
@@ -155,11 +235,13 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 	void SpriteComponent::SetColorMultiplier(const Color & color)
 	{
 		m_SpriteInfo->colorMultiplier = color;
+		MarkSpriteInfoChanged();
 	}
 
 	void SpriteComponent::SetHUDOptionEnabled(bool enabled)
 	{
 		m_SpriteInfo->bIsHud = enabled;
+		MarkSpriteInfoChanged();
 	}
 
 	bool SpriteComponent::IsHUDOptionEnabled() const
@@ -167,6 +249,17 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 		return m_SpriteInfo->bIsHud;
 	}
 
+	void SpriteComponent::SetStatic(bool isStatic)
+	{
+		m_SpriteInfo->bIsStatic = isStatic;
+		MarkSpriteInfoChanged();
+	}
+
+	bool SpriteComponent::IsStatic() const
+	{
+		return m_SpriteInfo->bIsStatic;
+	}
+
 	void SpriteComponent::SetTexture(
 		const tstring& filepath,
 		const tstring& spriteName,
@@ -184,6 +277,7 @@ having a SpriteSheet- or TextComponent."), STARENGINE_LOG_TAG);
 		m_SpriteName = spriteName;
 
 		TextureManager::GetInstance()->LoadTexture(m_FilePath.GetFullPath(),m_SpriteName);
+		m_TextureHandle = TextureManager::GetInstance()->GetTextureHandle(m_SpriteName);
 		m_Dimensions.x = TextureManager::GetInstance()->GetTextureDimensions(m_SpriteName).x / m_WidthSegments;
 		m_Dimensions.y =  TextureManager::GetInstance()->GetTextureDimensions(m_SpriteName).y / m_HeightSegments;
 		
@@ -4,6 +4,7 @@
 #include "../BaseComponent.h"
 #include "../../Helpers/FilePath.h"
 #include "../../Graphics/Color.h"
+#include "../../Graphics/TextureHandle.h"
 
 namespace star
 {
@@ -24,6 +25,8 @@ namespace star
 			, transformPtr(nullptr)
 			, colorMultiplier(Color::White)
 			, bIsHud(false)
+			, bIsStatic(false)
+			, version(0)
 		{
 
 		}
@@ -34,6 +37,10 @@ namespace star
 		TransformComponent* transformPtr;
 		Color colorMultiplier;
 		bool bIsHud;
+		//Static sprites are kept in a retained vertex buffer by the SpriteBatch
+		bool bIsStatic;
+		//Unique value, changed every time the info above changes
+		uint32 version;
 	};
 
 	/// <summary>
@@ -88,6 +95,13 @@ namespace star
 			float32 top,
 			float32 bottom
 			) const;
+		/// <summary>
+		/// Gets the world rectangle used by CheckCulling.
+		/// HUD and static sprites are unbounded.
+		/// </summary>
+		/// <param name="bounds">Output parameter: left, bottom, right, top.</param>
+		/// <returns>How the component takes part in culling.</returns>
+		virtual CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 		/// <summary>
 		/// Gets the file path of the texture.
@@ -126,6 +140,20 @@ namespace star
 		/// <returns></returns>
 		bool IsHUDOptionEnabled() const;
 
+		/// <summary>
+		/// Marks this Sprite as static. Static sprites are kept in a cached
+		/// vertex buffer by the SpriteBatch, which is only rebuilt when
+		/// the sprite or its transform changes. They are never culled.
+		/// </summary>
+		/// <param name="isStatic">True to make the sprite static.</param>
+		void SetStatic(bool isStatic);
+
+		/// <summary>
+		/// Determines whether this Sprite is static.
+		/// </summary>
+		/// <returns>True if the sprite is static.</returns>
+		bool IsStatic() const;
+
 		/// <summary>
 		/// Sets the texture of this sprite. Usefull if you want to change the texture at runtime.
 		/// </summary>
@@ -150,7 +178,9 @@ namespace star
 		/// </summary>
 		virtual void CreateUVCoords();
 		/// <summary>
-		/// Sets the uv coordinates.
+		/// Sets the uv coordinates, relative to the texture.
+		/// When the texture is packed in an atlas, 
+		/// they are remapped to the region of the texture in the atlas.
 		/// </summary>
 		/// <param name="coords">The uv coordinatess.</param>
 		void SetUVCoords(const vec4& coords);
@@ -158,6 +188,7 @@ namespace star
 		/// Fills the sprite information struct, to send to the <see cref="SpriteBatch"/>
 		/// </summary>
 		virtual void FillSpriteInfo();
+		void MarkSpriteInfoChanged();
 
 		uint32	m_WidthSegments,
 				m_HeightSegments, 
@@ -170,6 +201,15 @@ namespace star
 		tstring m_SpriteName;
 		
 		SpriteInfo* m_SpriteInfo;
+		vec4	m_UVCoords,
+				m_UVRegion;
+		//Set while the texture is still loaded asynchronously
+		//and the placeholder texture is drawn instead.
+		bool m_bTexturePending;
+		//Keeps the texture from being evicted while this sprite exists
+		TextureHandle m_TextureHandle;
+
+		static uint32 GenerateSpriteInfoVersion();
 
 		SpriteComponent(const SpriteComponent &);
 		SpriteComponent(SpriteComponent &&);
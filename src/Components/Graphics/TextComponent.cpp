@@ -4,6 +4,7 @@
 #include "SpriteComponent.h"
 #include "SpriteSheetComponent.h"
 #include "../../Graphics/SpriteBatch.h"
+#include <algorithm>
 
 namespace star
 {
@@ -21,6 +22,9 @@ namespace star
 		, m_TextInfo(nullptr)
 		, m_Font(nullptr)
 		, m_TextAlignment(HorizontalAlignment::left)
+		, m_GlyphTransforms()
+		, m_bLayoutChanged(true)
+		, m_bWorldQuadsChanged(true)
 	{
 		const auto * font = 
 			FontManager::GetInstance()->GetFont(fontName);
@@ -47,6 +51,9 @@ namespace star
 		, m_TextInfo(nullptr)
 		, m_Font()
 		, m_TextAlignment(HorizontalAlignment::left)
+		, m_GlyphTransforms()
+		, m_bLayoutChanged(true)
+		, m_bWorldQuadsChanged(true)
 	{
 		if(!FontManager::GetInstance()->LoadFont(
 				m_FileName,
@@ -127,6 +134,7 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 				+ (m_TextInfo->verticalSpacing * (count - 1));
 		m_TextInfo->textHeight = m_Dimensions.y;
 		GetTransform()->SetDimensionsYSafe(m_Dimensions.y);
+		MarkLayoutChanged();
 	}
 	
 	void TextComponent::CleanUpText(const tstring & str)
@@ -151,6 +159,7 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 	{
 		if(m_bInitialized)
 		{
+			MarkLayoutChanged();
 			m_TextInfo->horizontalTextOffset.clear();
 			if(m_TextAlignment == HorizontalAlignment::center)
 			{
@@ -299,9 +308,97 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 				);
 			return;
 		}
+		UpdateGlyphQuads();
+		UpdateWorldQuads();
 		SpriteBatch::GetInstance()->AddTextToQueue(m_TextInfo);
 	}
 
+	void TextComponent::MarkLayoutChanged()
+	{
+		m_bLayoutChanged = true;
+		if(m_pParentObject != nullptr)
+		{
+			m_pParentObject->MarkCullingBoundsDirty();
+		}
+	}
+
+	void TextComponent::UpdateGlyphQuads()
+	{
+		if(!m_bLayoutChanged)
+		{
+			return;
+		}
+		m_bLayoutChanged = false;
+		m_bWorldQuadsChanged = true;
+
+		std::vector<GlyphQuad> & glyphs = m_TextInfo->glyphs;
+		glyphs.clear();
+		glyphs.reserve(m_TextInfo->text.size());
+
+		int32 line_counter(0);
+		int32 offsetX(m_TextInfo->horizontalTextOffset.at(line_counter));
+		int32 offsetY(0);
+		int32 fontHeight(m_Font->GetMaxLetterHeight() + m_Font->GetMinLetterHeight());
+		for(auto it : m_TextInfo->text)
+		{
+			suchar character = static_cast<suchar>(it);
+			const CharacterInfo& charInfo = m_Font->GetCharacterInfo(character);
+			GlyphQuad glyph;
+			glyph.offsetX = float32(offsetX);
+			glyph.offsetY = float32(offsetY + charInfo.letterDimensions.y
+				+ m_TextInfo->textHeight - fontHeight);
+			offsetX += charInfo.letterDimensions.x;
+
+			if(character <= FIRST_REAL_ASCII_CHAR)
+			{
+				if(it == _T('\n'))
+				{
+					offsetY -= m_Font->GetMaxLetterHeight() + m_TextInfo->verticalSpacing;
+					++line_counter;
+					offsetX = m_TextInfo->horizontalTextOffset.at(line_counter);
+				}
+				//Control characters don't have a visible glyph
+				continue;
+			}
+
+			glyph.width = float32(charInfo.vertexDimensions.x);
+			glyph.height = float32(charInfo.vertexDimensions.y);
+			glyph.uLeft = SpriteBatch::PackUV(charInfo.uvOffset.x);
+			glyph.uRight = SpriteBatch::PackUV(charInfo.uvOffset.x + charInfo.uvDimensions.x);
+			glyph.vTop = SpriteBatch::PackUV(charInfo.uvOffset.y);
+			glyph.vBottom = SpriteBatch::PackUV(charInfo.uvOffset.y + charInfo.uvDimensions.y);
+			glyphs.push_back(glyph);
+		}
+	}
+
+	void TextComponent::UpdateWorldQuads()
+	{
+		//Changes every frame while the transform is in between two steps
+		mat4 worldMat = GetTransform()->GetInterpolatedWorldMatrix();
+		if(!m_bWorldQuadsChanged && worldMat == m_TextInfo->worldMatrix)
+		{
+			return;
+		}
+		m_bWorldQuadsChanged = false;
+		m_TextInfo->worldMatrix = worldMat;
+
+		const std::vector<GlyphQuad> & glyphs = m_TextInfo->glyphs;
+		m_GlyphTransforms.resize(glyphs.size());
+		for(uint32 i = 0; i < glyphs.size(); ++i)
+		{
+			const GlyphQuad & glyph = glyphs[i];
+			SetQuadTransform(worldMat, glyph.width, glyph.height,
+				m_GlyphTransforms[i], glyph.offsetX, glyph.offsetY);
+		}
+
+		m_TextInfo->worldCorners.resize(glyphs.size());
+		if(!glyphs.empty())
+		{
+			TransformQuadCorners(&m_GlyphTransforms[0], glyphs.size(),
+				&m_TextInfo->worldCorners[0]);
+		}
+	}
+
 	void TextComponent::Update(const Context& context)
 	{
 		FillTextInfo();
@@ -339,6 +436,26 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 	}
 
 
+	CullingBoundsType TextComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		if(m_TextInfo->bIsHud || m_Font == nullptr)
+		{
+			return CullingBoundsType::Unbounded;
+		}
+
+		pos objectPos = GetTransform()->GetWorldPosition();
+		float32 teRight = objectPos.x + float32(m_Font->GetStringLength(m_OrigText))
+			* GetTransform()->GetWorldScale().x;
+		float32 texTop = objectPos.y + float32(m_Font->GetMaxLetterHeight())
+			* GetTransform()->GetWorldScale().y;
+
+		bounds.x = std::min(objectPos.x, teRight);
+		bounds.y = std::min(objectPos.y, texTop);
+		bounds.z = std::max(objectPos.x, teRight);
+		bounds.w = std::max(objectPos.y, texTop);
+		return CullingBoundsType::Bounds;
+	}
+
 	void TextComponent::SetText(const tstring& text)
 	{
 		m_OrigText = text;
@@ -495,6 +612,7 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 	void TextComponent::SetVerticalSpacing(uint32 spacing)
 	{
 		m_TextInfo->verticalSpacing = spacing;
+		MarkLayoutChanged();
 		if(m_bInitialized && m_WrapWidth != NO_WRAPPING)
 		{
 			CleanUpText(CheckWrapping(
@@ -507,6 +625,10 @@ having a SpriteSheet- or SpriteComponent."), STARENGINE_LOG_TAG);
 	void TextComponent::SetHUDOptionEnabled(bool enabled)
 	{
 		m_TextInfo->bIsHud = enabled;
+		if(m_pParentObject != nullptr)
+		{
+			m_pParentObject->MarkCullingBoundsDirty();
+		}
 	}
 
 	bool TextComponent::IsHUDOptionEnabled() const
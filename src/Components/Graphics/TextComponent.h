@@ -3,12 +3,23 @@
 #include "../BaseComponent.h"
 #include "../../defines.h"
 #include "../../Graphics/Color.h"
+#include "../../Graphics/QuadTransform.h"
 #include <vector>
 
 namespace star
 {
 	class Font;
 
+	/// <summary>
+	/// Local space quad of one glyph, relative to the origin of the text.
+	/// </summary>
+	struct GlyphQuad
+	{
+		float32 offsetX, offsetY;
+		float32 width, height;
+		uint16 uLeft, uRight, vTop, vBottom;
+	};
+
 	/// <summary>
 	/// Information of a text element. 
 	/// Gets sent to the <see cref="SpriteBatch"> to process it correctly.
@@ -28,6 +39,9 @@ namespace star
 			, verticalSpacing(10)
 			, text()
 			, textHeight()
+			, glyphs()
+			, worldCorners()
+			, worldMatrix()
 		{}
 		const Font* font;
 		TransformComponent* transformPtr;
@@ -37,6 +51,12 @@ namespace star
 		int32 verticalSpacing;
 		tstring text;	
 		int32 textHeight;
+		//Cached by the TextComponent: the glyphs are only rebuilt when
+		//the layout changes, their corners when the transform changes.
+		std::vector<GlyphQuad> glyphs;
+		std::vector<QuadCorners> worldCorners;
+		//Interpolated world matrix the corners were built with
+		mat4 worldMatrix;
 	};
 
 	/// <summary>
@@ -100,6 +120,13 @@ namespace star
 			float32 top,
 			float32 bottom
 			) const;
+		/// <summary>
+		/// Gets the world rectangle used by CheckCulling.
+		/// HUD texts are unbounded.
+		/// </summary>
+		/// <param name="bounds">Output parameter: left, bottom, right, top.</param>
+		/// <returns>How the component takes part in culling.</returns>
+		virtual CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 		/// <summary>
 		/// Sets the text.
@@ -219,8 +246,27 @@ namespace star
 		/// Fills the text information struct, to send to the <see cref="SpriteBatch"/>
 		/// </summary>
 		virtual void FillTextInfo();
+
+		/// <summary>
+		/// Marks the glyph quads to be rebuilt before the next draw.
+		/// </summary>
+		void MarkLayoutChanged();
+
+		/// <summary>
+		/// Rebuilds the local space glyph quads when the layout changed.
+		/// </summary>
+		void UpdateGlyphQuads();
+
+		/// <summary>
+		/// Transforms the glyph quads to world space with the
+		/// interpolated world matrix, like the dynamic sprites,
+		/// when the glyphs or that matrix changed.
+		/// </summary>
+		void UpdateWorldQuads();
 	
 	private:
+		static const uint32 FIRST_REAL_ASCII_CHAR = 31;
+
 		uint32	m_FontSize,
 				m_StringLength;
 
@@ -235,6 +281,10 @@ namespace star
 		const Font* m_Font;
 		HorizontalAlignment m_TextAlignment;
 
+		std::vector<QuadTransformInput> m_GlyphTransforms;
+		bool m_bLayoutChanged,
+			 m_bWorldQuadsChanged;
+
 		/// <summary>
 		/// Calculates the wrapping.
 		/// </summary>
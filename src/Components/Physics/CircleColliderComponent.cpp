@@ -330,4 +330,9 @@ The collierComponent to check is a nullptr"), STARENGINE_LOG_TAG);
 				, GetRealRadius(), m_DrawColor, m_DrawSegments);
 		}		
 	}
+
+	CullingBoundsType CircleColliderComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::None;
+	}
 }
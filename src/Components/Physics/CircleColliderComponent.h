@@ -181,6 +181,12 @@ namespace star
 		/// </summary>
 		/// <returns>The amount of segments.</returns>
 		uint32 GetDrawSegments() const;
+		/// <summary>
+		/// Colliders are never drawn through culling.
+		/// </summary>
+		/// <param name="bounds">Unused.</param>
+		/// <returns>CullingBoundsType::None</returns>
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 	protected:
 		/// <summary>
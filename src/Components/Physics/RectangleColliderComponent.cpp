@@ -594,4 +594,9 @@ The collierComponent to check is a nullptr"), STARENGINE_LOG_TAG);
 			DebugDraw::GetInstance()->DrawSolidRect(GetCollisionRect(), m_DrawColor);
 		}
 	}
+
+	CullingBoundsType RectangleColliderComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::None;
+	}
 }
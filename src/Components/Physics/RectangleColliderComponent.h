@@ -211,6 +211,12 @@ namespace star
 		/// </summary>
 		/// <param name="width">The new height of the collision rectangle.</param>
 		void SetCollisionRectHeight(float32 height);
+		/// <summary>
+		/// Colliders are never drawn through culling.
+		/// </summary>
+		/// <param name="bounds">Unused.</param>
+		/// <returns>CullingBoundsType::None</returns>
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 
 	protected:
 		/// <summary>
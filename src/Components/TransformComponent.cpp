@@ -10,6 +10,7 @@ namespace star
 	TransformComponent::TransformComponent(star::Object* parent):
 		m_IsChanged(TransformChanged::ALL),
 		m_Invalidate(false),
+		m_Version(0),
 	#ifdef STAR2D
 		m_WorldPosition(0,0),
 		m_LocalPosition(0,0),
@@ -29,7 +30,9 @@ namespace star
 		m_WorldScale(1,1,1),
 		m_LocalScale(1,1,1),
 	#endif
-		m_World()
+		m_World(),
+		m_PreviousWorld(),
+		m_PreviousStep(0)
 	{
 		m_pParentObject = parent;
 	}
@@ -476,6 +479,29 @@ namespace star
 		return m_World;
 	}
 
+	mat4 TransformComponent::GetInterpolatedWorldMatrix() const
+	{
+		//Only a transform that changed during the last step is in between
+		const TimeManager* time = TimeManager::GetInstance();
+		float32 alpha = time->GetInterpolationAlpha();
+		if(alpha >= 1.0f || m_PreviousStep != time->GetStepCount())
+		{
+			return m_World;
+		}
+#ifdef STAR2D
+		//Around the middle of the object, so it turns in place
+		vec2 pivot(m_Dimensions.x / 2.0f, m_Dimensions.y / 2.0f);
+		return InterpolateAffine2D(m_PreviousWorld, m_World, pivot, alpha);
+#else
+		return Lerp(m_PreviousWorld, m_World, alpha);
+#endif
+	}
+
+	uint32 TransformComponent::GetVersion() const
+	{
+		return m_Version;
+	}
+
 	void TransformComponent::CheckForUpdate(bool force)
 	{
 		if(m_IsChanged == TransformChanged::NONE && !force && !m_Invalidate
@@ -498,6 +524,14 @@ namespace star
 			child->GetTransform()->IsChanged(true);
 		}
 
+		uint64 step = TimeManager::GetInstance()->GetStepCount();
+		if(m_PreviousStep != step)
+		{
+			m_PreviousWorld = m_World;
+			m_PreviousStep = step;
+		}
+
+		mat4 previousWorld = m_World;
 		SingleUpdate(m_World);
 
 		auto parent = m_pParentObject->GetParent();
@@ -506,6 +540,12 @@ namespace star
 			m_World = parent->GetTransform()->GetWorldMatrix() * m_World;
 		}
 
+		if(m_World != previousWorld)
+		{
+			++m_Version;
+			m_pParentObject->MarkCullingBoundsDirty();
+		}
+
 		DecomposeMatrix(m_World, m_WorldPosition, m_WorldScale, m_WorldRotation);
 
 		if(m_IsMirroredX)
@@ -574,6 +614,11 @@ namespace star
 
 	}
 
+	CullingBoundsType TransformComponent::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::None;
+	}
+
 	void TransformComponent::IsChanged(bool isChanged)
 	{
 		m_IsChanged = isChanged;
@@ -582,6 +627,8 @@ namespace star
 	void TransformComponent::InitializeComponent()
 	{
 		CheckForUpdate(true);
+		//Don't blend in from the origin
+		m_PreviousWorld = m_World;
 		m_Invalidate = true;
 	}
 }
\ No newline at end of file
@@ -25,6 +25,7 @@ namespace star
 
 		void Update(const Context& context);
 		void Draw();
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
 		void IsChanged(bool isChanged);
 #ifdef STAR2D
 		void Translate(const vec2& translation);
@@ -114,6 +115,14 @@ namespace star
 		const vec3& GetLocalScale();
 #endif
 		const mat4 & GetWorldMatrix() const;
+		//Blended between the last two steps with the interpolation alpha
+		//of the TimeManager, for drawing with a fixed timestep.
+		//Rotation, scale and position are blended apart in 2D,
+		//in 3D only the translation is blended correctly.
+		mat4 GetInterpolatedWorldMatrix() const;
+		//Increases every time the world matrix changes,
+		//used to check if cached data based on it is still valid.
+		uint32 GetVersion() const;
 
 	private:
 		void InitializeComponent();
@@ -123,6 +132,7 @@ namespace star
 
 		suchar m_IsChanged;
 		bool m_Invalidate;
+		uint32 m_Version;
 
 #ifdef STAR2D
 		pos m_WorldPosition, m_LocalPosition;
@@ -140,6 +150,9 @@ namespace star
 		// [TODO] add 3D mirroring!
 #endif
 		mat4 m_World;
+		//World matrix at the start of the step it last changed in
+		mat4 m_PreviousWorld;
+		uint64 m_PreviousStep;
 
 		TransformComponent(const TransformComponent& yRef);
 		TransformComponent(TransformComponent&& yRef);
@@ -87,7 +87,6 @@ namespace star {
 				mMainGame->Update(mContext);
 				mMainGame->Draw();
 			}
-			usleep(100);
 			TimeManager::GetInstance()->StopMonitoring();
 		}
 	}
@@ -1,5 +1,6 @@
 #include "Font.h"
 #include "../Logger.h"
+#include "GLStateCache.h"
 
 #ifndef DESKTOP
 #include "Resource.h"
@@ -11,7 +12,7 @@ namespace star
 	Font::Font():
 		m_FontPath(EMPTY_STRING),
 		mFace(0),
-		mTextures(nullptr),
+		mTextureID(0),
 		mMaxLetterHeight(),
 		mMinLetterHeight(),
 		mCharacterInfoMap(),
@@ -27,7 +28,6 @@ namespace star
 	bool Font::Init(const tstring& path, uint32 size, FT_Library& library)
 	{
 		mSize = size;
-		mTextures = new GLuint[FONT_TEXTURES];
 		m_FontPath = path;
 
 #ifdef DESKTOP
@@ -84,26 +84,50 @@ namespace star
 		int32 iSize = int32(size);
 		FT_Set_Char_Size(mFace, iSize << 6, iSize << 6, FONT_DPI, FONT_DPI);
 
-		glGenTextures(FONT_TEXTURES, mTextures);
-		for(suchar i = 0; i < FONT_TEXTURES; ++i)
+		std::vector<GlyphBitmap> glyphs(FONT_GLYPHS);
+		for(suchar i = 0; i < FONT_GLYPHS; ++i)
 		{
 			mCharacterInfoMap.insert(std::make_pair(i, CharacterInfo()));
-			Make_D_List(mFace, i, mTextures);
+			Make_D_List(mFace, i, glyphs[i]);
 		}
 		FT_Done_Face(mFace);
+
+		//Find the smallest power of two atlas all glyphs fit in
+		int32 width(64), height(64);
+		while(!PackGlyphs(glyphs, width, height))
+		{
+			if(width > height)
+			{
+				height <<= 1;
+			}
+			else
+			{
+				width <<= 1;
+			}
+			if(width > FONT_ATLAS_MAX_SIZE || height > FONT_ATLAS_MAX_SIZE)
+			{
+				LOG(star::LogLevel::Error,
+					_T("Font : ") + path +
+					_T(" ,glyphs don't fit in the maximum atlas size."),
+					STARENGINE_LOG_TAG);
+				return false;
+			}
+		}
+
+		CreateAtlas(glyphs, width, height);
 		return true;
 	}
 
 	void Font::DeleteFont()
 	{
-		glDeleteTextures(FONT_TEXTURES,mTextures);
-		delete[] mTextures;
+		GLStateCache::GetInstance()->DeleteTextures(1, &mTextureID);
+		mTextureID = 0;
 #ifdef ANDROID
 		delete [] mFontBuffer;
 #endif
 	}
 
-	void Font::Make_D_List(FT_Face face, suchar ch,GLuint * tex_base)
+	void Font::Make_D_List(FT_Face face, suchar ch, GlyphBitmap& glyph)
 	{
 		auto error = FT_Load_Char(face, ch, FT_LOAD_DEFAULT);
 		if(error)
@@ -123,36 +147,20 @@ namespace star
 
 		FT_Bitmap& bitmap = face->glyph->bitmap;
 
-		int32 width = NextPowerOfTwo(bitmap.width);
-		int32 height = NextPowerOfTwo(bitmap.rows);
-
-		GLubyte* expanded_data = new GLubyte[2 * width * height];
-
-		for(int32 j = 0; j < height; ++j) 
+		//Keep a copy of the coverage values, 
+		//the glyphs get packed in the atlas once all of them are rendered
+		glyph.width = bitmap.width;
+		glyph.height = bitmap.rows;
+		glyph.pixels.resize(glyph.width * glyph.height);
+		int32 pitch = bitmap.pitch < 0 ? -bitmap.pitch : bitmap.pitch;
+		for(int32 j = 0; j < glyph.height; ++j) 
 		{
-			for(int32 i = 0; i < width; ++i) 
+			for(int32 i = 0; i < glyph.width; ++i) 
 			{
-				expanded_data[2 * (i + j * width)] = 255;
-				expanded_data[2 * (i + j * width) + 1] = 
-					(i >= bitmap.width || j >= bitmap.rows) ? 0 : bitmap.buffer[i + bitmap.width * j];
+				glyph.pixels[i + j * glyph.width] = bitmap.buffer[i + pitch * j];
 			}
 		}
 
-		glBindTexture(GL_TEXTURE_2D, tex_base[ch]);
-		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-#ifdef DESKTOP
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, expanded_data);
-#else
-		//For android "internal format" must be the same as "format" in glTexImage2D
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, expanded_data);
-#endif
-		OPENGL_LOG();
-		delete[] expanded_data;
-
-		//uvs
-		float32 x = static_cast<float32>(bitmap.width) / static_cast<float32>(width);
-		float32 y = static_cast<float32>(bitmap.rows) / static_cast<float32>(height);
 		//letter height
 		int32 dimX = (face->glyph->metrics.horiAdvance / 64);
 		int32 dimY = ((face->glyph->metrics.horiBearingY) - (face->glyph->metrics.height)) / 64;		
@@ -166,7 +174,79 @@ namespace star
 		}
 		mCharacterInfoMap.at(ch).letterDimensions = ivec2(dimX, dimY);
 		mCharacterInfoMap.at(ch).vertexDimensions = vec2(bitmap.width, bitmap.rows);
-		mCharacterInfoMap.at(ch).uvDimensions = vec2(x, y);
+	}
+
+	bool Font::PackGlyphs(std::vector<GlyphBitmap>& glyphs, int32 width, int32 height) const
+	{
+		//Simple shelf packer, the glyphs of one font have a similar height
+		int32 x(FONT_ATLAS_PADDING),
+			  y(FONT_ATLAS_PADDING),
+			  shelfHeight(0);
+		for(GlyphBitmap& glyph : glyphs)
+		{
+			if(x + glyph.width + FONT_ATLAS_PADDING > width)
+			{
+				x = FONT_ATLAS_PADDING;
+				y += shelfHeight + FONT_ATLAS_PADDING;
+				shelfHeight = 0;
+			}
+			if(x + glyph.width + FONT_ATLAS_PADDING > width
+				|| y + glyph.height + FONT_ATLAS_PADDING > height)
+			{
+				return false;
+			}
+			glyph.position = ivec2(x, y);
+			x += glyph.width + FONT_ATLAS_PADDING;
+			if(glyph.height > shelfHeight)
+			{
+				shelfHeight = glyph.height;
+			}
+		}
+		return true;
+	}
+
+	void Font::CreateAtlas(const std::vector<GlyphBitmap>& glyphs, int32 width, int32 height)
+	{
+		//Luminance is always white, the glyph coverage goes in the alpha channel
+		std::vector<GLubyte> atlasData(2 * width * height, 0);
+		for(int32 i = 0; i < width * height; ++i)
+		{
+			atlasData[2 * i] = 255;
+		}
+
+		float32 fWidth = static_cast<float32>(width);
+		float32 fHeight = static_cast<float32>(height);
+		for(suchar ch = 0; ch < glyphs.size(); ++ch)
+		{
+			const GlyphBitmap& glyph = glyphs[ch];
+			for(int32 j = 0; j < glyph.height; ++j)
+			{
+				for(int32 i = 0; i < glyph.width; ++i)
+				{
+					int32 index = (glyph.position.x + i) + (glyph.position.y + j) * width;
+					atlasData[2 * index + 1] = glyph.pixels[i + j * glyph.width];
+				}
+			}
+
+			//uvs
+			CharacterInfo& info = mCharacterInfoMap.at(ch);
+			info.uvOffset = vec2(glyph.position.x / fWidth, glyph.position.y / fHeight);
+			info.uvDimensions = vec2(glyph.width / fWidth, glyph.height / fHeight);
+		}
+
+		glGenTextures(1, &mTextureID);
+		GLStateCache::GetInstance()->BindTexture(mTextureID);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+#ifdef DESKTOP
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, &atlasData[0]);
+#else
+		//For android "internal format" must be the same as "format" in glTexImage2D
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, &atlasData[0]);
+#endif
+		OPENGL_LOG();
 	}
 
 	const tstring & Font::GetFontPath() const
@@ -174,9 +254,9 @@ namespace star
 		return m_FontPath;
 	}
 
-	GLuint* Font::GetTextures() const
+	GLuint Font::GetTextureID() const
 	{
-		return mTextures;
+		return mTextureID;
 	}
 
 	uint32 Font::GetFontSize() const 
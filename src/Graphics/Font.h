@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 #include "../defines.h"
 #include "../Helpers/FilePath.h"
 #include "../Helpers/Helpers.h"
@@ -18,19 +19,24 @@
 namespace star
 {
 #define FONT_DPI 96
-#define FONT_TEXTURES 128
+#define FONT_GLYPHS 128
+#define FONT_ATLAS_PADDING 1
+#define FONT_ATLAS_MAX_SIZE 2048
 
 	struct CharacterInfo
 	{
 		CharacterInfo()
 			: vertexDimensions()
+			, uvOffset()
 			, uvDimensions()
 			, letterDimensions() 
 		{
 
 		}
 
+		//uvOffset is the top left corner of the glyph in the atlas
 		vec2	vertexDimensions,
+				uvOffset,
 				uvDimensions;
 		ivec2	letterDimensions;
 
@@ -47,7 +53,7 @@ namespace star
 
 		const tstring & GetFontPath() const;
 
-		GLuint* GetTextures() const;
+		GLuint GetTextureID() const;
 		uint32 GetFontSize() const;
 		
 		const std::unordered_map<suchar, CharacterInfo>& GetCharacterInfoMap() const;
@@ -57,12 +63,31 @@ namespace star
 		uint32 GetStringLength(const tstring& string) const;
 
 	private:
-		void Make_D_List(FT_Face face, suchar ch,GLuint * tex_base);
+		struct GlyphBitmap
+		{
+			GlyphBitmap()
+				: width(0)
+				, height(0)
+				, position()
+				, pixels()
+			{
+
+			}
+
+			int32 width,
+				  height;
+			ivec2 position;
+			std::vector<uint8> pixels;
+		};
+
+		void Make_D_List(FT_Face face, suchar ch, GlyphBitmap& glyph);
+		bool PackGlyphs(std::vector<GlyphBitmap>& glyphs, int32 width, int32 height) const;
+		void CreateAtlas(const std::vector<GlyphBitmap>& glyphs, int32 width, int32 height);
 		int32 NextPowerOfTwo(int32 number) const;
 
 		tstring m_FontPath;
 		FT_Face mFace;
-		GLuint* mTextures;
+		GLuint mTextureID;
 		int32	mMaxLetterHeight,
 				mMinLetterHeight;
 
@@ -0,0 +1,275 @@
+#include "GLStateCache.h"
+#include "GraphicsManager.h"
+
+namespace star
+{
+	GLStateCache::GLStateCache()
+		: Singleton<GLStateCache>()
+		, m_Program(0)
+		, m_ActiveTextureUnit(0)
+		, m_ArrayBuffer(0)
+		, m_ElementArrayBuffer(0)
+		, m_EnabledVertexAttribs(0)
+		, m_BlendSource(GL_ONE)
+		, m_BlendDestination(GL_ZERO)
+		, m_bBlendEnabled(false)
+		, m_bProgramKnown(false)
+		, m_bActiveTextureUnitKnown(false)
+		, m_bArrayBufferKnown(false)
+		, m_bElementArrayBufferKnown(false)
+		, m_bBlendEnabledKnown(false)
+		, m_bBlendFuncKnown(false)
+		, m_KnownTextureUnits(0)
+		, m_KnownVertexAttribs(0)
+	{
+		for(uint32 i = 0; i < MAX_TEXTURE_UNITS; ++i)
+		{
+			m_Textures[i] = 0;
+		}
+	}
+
+	GLStateCache::~GLStateCache()
+	{
+	}
+
+	void GLStateCache::Invalidate()
+	{
+		m_bProgramKnown = false;
+		m_bActiveTextureUnitKnown = false;
+		m_bArrayBufferKnown = false;
+		m_bElementArrayBufferKnown = false;
+		m_bBlendEnabledKnown = false;
+		m_bBlendFuncKnown = false;
+		m_KnownTextureUnits = 0;
+		m_KnownVertexAttribs = 0;
+	}
+
+	void GLStateCache::UseProgram(GLuint program)
+	{
+		bool redundant = m_bProgramKnown && m_Program == program;
+		if(!redundant)
+		{
+			glUseProgram(program);
+			m_Program = program;
+			m_bProgramKnown = true;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::BindTexture(GLuint texture, uint32 unit)
+	{
+		if(unit >= MAX_TEXTURE_UNITS)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			m_bActiveTextureUnitKnown = false;
+			CountStateChange(false);
+			return;
+		}
+
+		const uint32 unitBit = 1u << unit;
+		bool redundant = (m_KnownTextureUnits & unitBit) != 0 
+			&& m_Textures[unit] == texture;
+		if(!redundant)
+		{
+			if(!m_bActiveTextureUnitKnown || m_ActiveTextureUnit != unit)
+			{
+				glActiveTexture(GL_TEXTURE0 + unit);
+				m_ActiveTextureUnit = unit;
+				m_bActiveTextureUnitKnown = true;
+			}
+			glBindTexture(GL_TEXTURE_2D, texture);
+			m_Textures[unit] = texture;
+			m_KnownTextureUnits |= unitBit;
+			++GraphicsManager::GetInstance()->GetCurrentRenderStats().textureBinds;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+	{
+		GLuint* binding = GetBufferBinding(target);
+		if(binding == nullptr)
+		{
+			glBindBuffer(target, buffer);
+			CountStateChange(false);
+			return;
+		}
+
+		bool& known = target == GL_ARRAY_BUFFER ? 
+			m_bArrayBufferKnown : m_bElementArrayBufferKnown;
+		bool redundant = known && *binding == buffer;
+		if(!redundant)
+		{
+			glBindBuffer(target, buffer);
+			*binding = buffer;
+			known = true;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::SetVertexAttribArrayEnabled(GLuint index, bool enabled)
+	{
+		if(index >= MAX_VERTEX_ATTRIBS)
+		{
+			if(enabled)
+			{
+				glEnableVertexAttribArray(index);
+			}
+			else
+			{
+				glDisableVertexAttribArray(index);
+			}
+			CountStateChange(false);
+			return;
+		}
+
+		const uint32 attribBit = 1u << index;
+		bool redundant = (m_KnownVertexAttribs & attribBit) != 0
+			&& ((m_EnabledVertexAttribs & attribBit) != 0) == enabled;
+		if(!redundant)
+		{
+			if(enabled)
+			{
+				glEnableVertexAttribArray(index);
+				m_EnabledVertexAttribs |= attribBit;
+			}
+			else
+			{
+				glDisableVertexAttribArray(index);
+				m_EnabledVertexAttribs &= ~attribBit;
+			}
+			m_KnownVertexAttribs |= attribBit;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::SetEnabledVertexAttribArrays(uint32 mask)
+	{
+		//Attributes that are unknown and have to stay disabled are
+		//left alone, nothing in the engine enables them behind our back.
+		uint32 changed = (m_EnabledVertexAttribs ^ mask) | (mask & ~m_KnownVertexAttribs);
+		for(GLuint index = 0; changed != 0; ++index, changed >>= 1)
+		{
+			if((changed & 1) != 0)
+			{
+				SetVertexAttribArrayEnabled(index, (mask & (1u << index)) != 0);
+			}
+		}
+	}
+
+	uint32 GLStateCache::CreateVertexAttribMask(const GLuint* attributes, uint32 amount)
+	{
+		uint32 mask(0);
+		for(uint32 i = 0; i < amount; ++i)
+		{
+			if(attributes[i] < MAX_VERTEX_ATTRIBS)
+			{
+				mask |= 1u << attributes[i];
+			}
+		}
+		return mask;
+	}
+
+	void GLStateCache::SetBlendEnabled(bool enabled)
+	{
+		bool redundant = m_bBlendEnabledKnown && m_bBlendEnabled == enabled;
+		if(!redundant)
+		{
+			if(enabled)
+			{
+				glEnable(GL_BLEND);
+			}
+			else
+			{
+				glDisable(GL_BLEND);
+			}
+			m_bBlendEnabled = enabled;
+			m_bBlendEnabledKnown = true;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::SetBlendFunc(GLenum source, GLenum destination)
+	{
+		bool redundant = m_bBlendFuncKnown 
+			&& m_BlendSource == source 
+			&& m_BlendDestination == destination;
+		if(!redundant)
+		{
+			glBlendFunc(source, destination);
+			m_BlendSource = source;
+			m_BlendDestination = destination;
+			m_bBlendFuncKnown = true;
+		}
+		CountStateChange(redundant);
+	}
+
+	void GLStateCache::DeleteProgram(GLuint program)
+	{
+		//A program that is in use is only flagged for deletion,
+		//but its name can't be reused until it's unbound.
+		glDeleteProgram(program);
+		if(m_Program == program)
+		{
+			m_bProgramKnown = false;
+		}
+	}
+
+	void GLStateCache::DeleteTextures(GLsizei amount, const GLuint* textures)
+	{
+		glDeleteTextures(amount, textures);
+		for(GLsizei i = 0; i < amount; ++i)
+		{
+			for(uint32 unit = 0; unit < MAX_TEXTURE_UNITS; ++unit)
+			{
+				if(m_Textures[unit] == textures[i])
+				{
+					m_Textures[unit] = 0;
+				}
+			}
+		}
+	}
+
+	void GLStateCache::DeleteBuffers(GLsizei amount, const GLuint* buffers)
+	{
+		glDeleteBuffers(amount, buffers);
+		for(GLsizei i = 0; i < amount; ++i)
+		{
+			if(m_ArrayBuffer == buffers[i])
+			{
+				m_ArrayBuffer = 0;
+			}
+			if(m_ElementArrayBuffer == buffers[i])
+			{
+				m_ElementArrayBuffer = 0;
+			}
+		}
+	}
+
+	void GLStateCache::CountStateChange(bool redundant) const
+	{
+		RenderStats & stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		if(redundant)
+		{
+			++stats.redundantStateChanges;
+		}
+		else
+		{
+			++stats.stateChanges;
+		}
+	}
+
+	GLuint* GLStateCache::GetBufferBinding(GLenum target)
+	{
+		switch(target)
+		{
+		case GL_ARRAY_BUFFER:
+			return &m_ArrayBuffer;
+		case GL_ELEMENT_ARRAY_BUFFER:
+			return &m_ElementArrayBuffer;
+		default:
+			return nullptr;
+		}
+	}
+}
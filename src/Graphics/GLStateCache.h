@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../defines.h"
+#include "../Helpers/Singleton.h"
+
+#ifdef DESKTOP
+#include <glew.h>
+#else
+#include <GLES2/gl2.h>
+#endif
+
+namespace star
+{
+	/// <summary>
+	/// Shadows the GL state the engine changes while drawing:
+	/// the bound program, textures per unit, buffers, enabled vertex
+	/// attribute arrays and the blend state. Calls that wouldn't change
+	/// anything are skipped and counted in the RenderStats of the frame.
+	/// All engine code has to go through this class for this state,
+	/// else the shadow copy gets out of sync with the driver.
+	/// </summary>
+	class GLStateCache final : public Singleton<GLStateCache>
+	{
+	public:
+		friend Singleton<GLStateCache>;
+
+		static const uint32 MAX_TEXTURE_UNITS = 8;
+		static const uint32 MAX_VERTEX_ATTRIBS = 32;
+
+		/// <summary>
+		/// Forgets all cached state, the next call of every kind is sent to GL.
+		/// Call this when the context was recreated or when external code
+		/// changed the state directly.
+		/// </summary>
+		void Invalidate();
+
+		/// <summary>
+		/// Binds a program, wraps glUseProgram.
+		/// </summary>
+		/// <param name="program">The program, 0 to unbind.</param>
+		void UseProgram(GLuint program);
+		/// <summary>
+		/// Binds a 2D texture to a texture unit.
+		/// Changes the active texture unit when needed.
+		/// </summary>
+		/// <param name="texture">The texture, 0 to unbind.</param>
+		/// <param name="unit">The texture unit, counting from 0.</param>
+		void BindTexture(GLuint texture, uint32 unit = 0);
+		/// <summary>
+		/// Binds a buffer, wraps glBindBuffer.
+		/// Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached.
+		/// </summary>
+		/// <param name="target">The binding point.</param>
+		/// <param name="buffer">The buffer, 0 to unbind.</param>
+		void BindBuffer(GLenum target, GLuint buffer);
+		/// <summary>
+		/// Enables or disables one vertex attribute array.
+		/// </summary>
+		void SetVertexAttribArrayEnabled(GLuint index, bool enabled);
+		/// <summary>
+		/// Enables the vertex attribute arrays in the mask,
+		/// where bit i stands for attribute i. Arrays enabled through
+		/// the cache that aren't in the mask are disabled, arrays the
+		/// cache never touched are left as they are.
+		/// </summary>
+		/// <param name="mask">The attributes to enable.</param>
+		void SetEnabledVertexAttribArrays(uint32 mask);
+		/// <summary>
+		/// Creates the mask for SetEnabledVertexAttribArrays.
+		/// Attributes the program doesn't have (-1) are skipped.
+		/// </summary>
+		static uint32 CreateVertexAttribMask(const GLuint* attributes, uint32 amount);
+		void SetBlendEnabled(bool enabled);
+		void SetBlendFunc(GLenum source, GLenum destination);
+
+		/// <summary>
+		/// Wraps the glDelete functions. GL unbinds deleted objects,
+		/// and their names can be handed out again, so the cache
+		/// has to forget the bindings of them.
+		/// </summary>
+		void DeleteProgram(GLuint program);
+		void DeleteTextures(GLsizei amount, const GLuint* textures);
+		void DeleteBuffers(GLsizei amount, const GLuint* buffers);
+
+	private:
+		GLStateCache();
+		~GLStateCache();
+
+		void CountStateChange(bool redundant) const;
+		GLuint* GetBufferBinding(GLenum target);
+
+		GLuint m_Program;
+		GLuint m_Textures[MAX_TEXTURE_UNITS];
+		uint32 m_ActiveTextureUnit;
+		GLuint m_ArrayBuffer,
+			   m_ElementArrayBuffer;
+		uint32 m_EnabledVertexAttribs;
+		GLenum m_BlendSource,
+			   m_BlendDestination;
+		bool m_bBlendEnabled;
+
+		//Every piece of state is unknown until it's set once
+		//through the cache after an Invalidate.
+		bool m_bProgramKnown,
+			 m_bActiveTextureUnitKnown,
+			 m_bArrayBufferKnown,
+			 m_bElementArrayBufferKnown,
+			 m_bBlendEnabledKnown,
+			 m_bBlendFuncKnown;
+		uint32 m_KnownTextureUnits;
+		uint32 m_KnownVertexAttribs;
+
+		GLStateCache(const GLStateCache& yRef);
+		GLStateCache(GLStateCache&& yRef);
+		GLStateCache& operator=(const GLStateCache& yRef);
+		GLStateCache& operator=(GLStateCache&& yRef);
+	};
+}
@@ -1,16 +1,21 @@
 #include "GraphicsManager.h"
 #include "SpriteBatch.h"
+#include "GLStateCache.h"
 #include "ScaleSystem.h"
+#include "TextureCompression.h"
 #include "../Logger.h"
 #include "../defines.h"
 #include "../Scenes/SceneManager.h"
 #include "../Objects/BaseCamera.h"
 #include "../Scenes/BaseScene.h"
 #include "../Components/CameraComponent.h"
+#include "../Helpers/Helpers.h"
 
 #ifdef DESKTOP
 #include <wglext.h>
 #endif
+#include <cstdio>
+#include <cstring>
 
 #ifdef MOBILE
 #include <GLES/gl.h>
@@ -29,10 +34,28 @@ namespace star
 		, mViewportResolution(0,0)
 		, mbHasWindowChanged(false)
 		, mIsInitialized(false)
+		, mbInstancingSupported(false)
+		, mbProgramBinarySupported(false)
+		, mbETC1Supported(false)
+		, mbETC2Supported(false)
+		, mbS3TCSupported(false)
+		, mMaxTextureSize(0)
+		, mRenderStats()
+		, mLastRenderStats()
+		, mFrameCount(0)
+		, mRenderStatsFile()
+		, mRenderStatsDirectory(DirectoryMode::internal)
+		, mRenderStatsRecord()
+		, mRecordedFrames(0)
+		, mbRecordingRenderStats(false)
 #ifdef DESKTOP
 		, mWglSwapIntervalEXT(NULL)
 		, mWglGetSwapIntervalEXT(NULL)
 #else
+		, mGlDrawArraysInstanced(NULL)
+		, mGlVertexAttribDivisor(NULL)
+		, mGlGetProgramBinary(NULL)
+		, mGlProgramBinary(NULL)
 		, mDisplay()
 		, mSurface()
 		, mContext()
@@ -44,6 +67,7 @@ namespace star
 
 	GraphicsManager::~GraphicsManager()
 	{
+		StopRenderStatsRecording();
 		LOG(star::LogLevel::Info,
 			_T("Graphics Manager : Destructor"), STARENGINE_LOG_TAG);
 	}
@@ -144,6 +168,9 @@ namespace star
 			//Initializes base GL state.
 			//DEPTH_TEST is default disabled
 			InitializeOpenGLStates();
+			InitializeInstancing();
+			InitializeProgramBinaries();
+			InitializeCompressedTextures();
 			mIsInitialized = true;
 		}
 	}
@@ -197,12 +224,19 @@ namespace star
 					_T("Graphics Manager : Could not create surface"), STARENGINE_LOG_TAG);
 				return;
 			}
+			//Try an OpenGL ES 3 context first, for instanced rendering.
+			//GLES 3 is backwards compatible, so nothing else changes.
 			EGLint contextAttrs[] = {
-				 EGL_CONTEXT_CLIENT_VERSION, 2,
+				 EGL_CONTEXT_CLIENT_VERSION, 3,
 				 EGL_NONE
 			};
 			mContext = eglCreateContext(mDisplay, lConfig, EGL_NO_CONTEXT, contextAttrs);
 			if (mContext == EGL_NO_CONTEXT)
+			{
+				contextAttrs[1] = 2;
+				mContext = eglCreateContext(mDisplay, lConfig, EGL_NO_CONTEXT, contextAttrs);
+			}
+			if (mContext == EGL_NO_CONTEXT)
 			{
 				LOG(star::LogLevel::Error,
 					_T("Graphics Manager : Could not create context"), STARENGINE_LOG_TAG);
@@ -225,6 +259,9 @@ namespace star
 			mScreenResolution = mViewportResolution;
 			glViewport(0, 0, mViewportResolution.x, mViewportResolution.y);
 			InitializeOpenGLStates();
+			InitializeInstancing();
+			InitializeProgramBinaries();
+			InitializeCompressedTextures();
 			LOG(star::LogLevel::Info,
 				_T("Graphics Manager : Initialized"), STARENGINE_LOG_TAG);
 
@@ -264,18 +301,201 @@ namespace star
 	{
 		//glDisable(GL_DEPTH_TEST);
 		glClearColor(0.f, 0.f, 0.f, 1.0f);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_BLEND);
+		//The context is new, nothing the cache knows is valid anymore
+		GLStateCache::GetInstance()->Invalidate();
+		GLStateCache::GetInstance()->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::GetInstance()->SetBlendEnabled(true);
+	}
+
+	void GraphicsManager::InitializeInstancing()
+	{
+#ifdef DESKTOP
+		mbInstancingSupported = GLEW_VERSION_3_3 != 0;
+#else
+		const schar* version = reinterpret_cast<const schar*>(glGetString(GL_VERSION));
+		int32 major(0);
+		if(version != NULL && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+		{
+			mGlDrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)
+				eglGetProcAddress("glDrawArraysInstanced");
+			mGlVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC)
+				eglGetProcAddress("glVertexAttribDivisor");
+		}
+		mbInstancingSupported = mGlDrawArraysInstanced != NULL
+			&& mGlVertexAttribDivisor != NULL;
+#endif
+		LOG(star::LogLevel::Info,
+			mbInstancingSupported ? _T("Graphics Manager : Instanced rendering supported")
+				: _T("Graphics Manager : Instanced rendering not supported"),
+			STARENGINE_LOG_TAG);
+	}
+
+	bool GraphicsManager::IsInstancingSupported() const
+	{
+		return mbInstancingSupported;
+	}
+
+	void GraphicsManager::DrawArraysInstanced(GLenum mode, GLint first,
+		GLsizei count, GLsizei instanceCount) const
+	{
+#ifdef DESKTOP
+		glDrawArraysInstanced(mode, first, count, instanceCount);
+#else
+		mGlDrawArraysInstanced(mode, first, count, instanceCount);
+#endif
+	}
+
+	void GraphicsManager::VertexAttribDivisor(GLuint index, GLuint divisor) const
+	{
+#ifdef DESKTOP
+		glVertexAttribDivisor(index, divisor);
+#else
+		mGlVertexAttribDivisor(index, divisor);
+#endif
+	}
+
+	void GraphicsManager::InitializeProgramBinaries()
+	{
+#ifdef DESKTOP
+		mbProgramBinarySupported = GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+#else
+		const schar* version = reinterpret_cast<const schar*>(glGetString(GL_VERSION));
+		const schar* extensions = reinterpret_cast<const schar*>(glGetString(GL_EXTENSIONS));
+		int32 major(0);
+		if(version != NULL && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+		{
+			mGlGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)
+				eglGetProcAddress("glGetProgramBinary");
+			mGlProgramBinary = (PFNGLPROGRAMBINARYPROC)
+				eglGetProcAddress("glProgramBinary");
+		}
+		else if(extensions != NULL && strstr(extensions, "GL_OES_get_program_binary") != NULL)
+		{
+			mGlGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)
+				eglGetProcAddress("glGetProgramBinaryOES");
+			mGlProgramBinary = (PFNGLPROGRAMBINARYPROC)
+				eglGetProcAddress("glProgramBinaryOES");
+		}
+		mbProgramBinarySupported = mGlGetProgramBinary != NULL
+			&& mGlProgramBinary != NULL;
+#endif
+		//Some drivers expose the functions without supporting a single format
+		if(mbProgramBinarySupported)
+		{
+			GLint formats(0);
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			mbProgramBinarySupported = formats > 0;
+		}
+		LOG(star::LogLevel::Info,
+			mbProgramBinarySupported ? _T("Graphics Manager : Program binaries supported")
+				: _T("Graphics Manager : Program binaries not supported"),
+			STARENGINE_LOG_TAG);
+	}
+
+	bool GraphicsManager::IsProgramBinarySupported() const
+	{
+		return mbProgramBinarySupported;
+	}
+
+	void GraphicsManager::SetProgramBinaryRetrievable(GLuint program) const
+	{
+		//Desktop drivers only keep the binary around when asked before linking,
+		//GLES always allows retrieving it.
+#ifdef DESKTOP
+		if(mbProgramBinarySupported)
+		{
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+#endif
+	}
+
+	void GraphicsManager::GetProgramBinary(GLuint program, GLsizei bufferSize,
+		GLsizei* length, GLenum* format, void* binary) const
+	{
+#ifdef DESKTOP
+		glGetProgramBinary(program, bufferSize, length, format, binary);
+#else
+		mGlGetProgramBinary(program, bufferSize, length, format, binary);
+#endif
+	}
+
+	void GraphicsManager::ProgramBinary(GLuint program, GLenum format,
+		const void* binary, GLsizei length) const
+	{
+#ifdef DESKTOP
+		glProgramBinary(program, format, binary, length);
+#else
+		mGlProgramBinary(program, format, binary, length);
+#endif
+	}
+
+	void GraphicsManager::InitializeCompressedTextures()
+	{
+		const schar* extensions = reinterpret_cast<const schar*>(glGetString(GL_EXTENSIONS));
+#ifdef DESKTOP
+		mbETC2Supported = GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+		mbS3TCSupported = GLEW_EXT_texture_compression_s3tc != 0;
+#else
+		const schar* version = reinterpret_cast<const schar*>(glGetString(GL_VERSION));
+		int32 major(0);
+		mbETC2Supported = version != NULL
+			&& sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3;
+		mbS3TCSupported = extensions != NULL
+			&& strstr(extensions, "GL_EXT_texture_compression_s3tc") != NULL;
+#endif
+		mbETC1Supported = extensions != NULL
+			&& strstr(extensions, "GL_OES_compressed_ETC1_RGB8_texture") != NULL;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &mMaxTextureSize);
+
+		LOG(star::LogLevel::Info,
+			tstring(_T("Graphics Manager : Compressed textures: ETC1 ")) +
+			(mbETC1Supported || mbETC2Supported ? _T("yes") : _T("no")) +
+			_T(", ETC2 ") + (mbETC2Supported ? _T("yes") : _T("no")) +
+			_T(", S3TC ") + (mbS3TCSupported ? _T("yes") : _T("no")),
+			STARENGINE_LOG_TAG);
+	}
+
+	bool GraphicsManager::IsCompressedTextureFormatSupported(GLenum format) const
+	{
+		switch(format)
+		{
+		case GL_ETC1_RGB8_OES:
+			//ETC1 data can be uploaded as ETC2 as well
+			return mbETC1Supported || mbETC2Supported;
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			return mbETC2Supported;
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return mbS3TCSupported;
+		default:
+			return false;
+		}
+	}
+
+	int32 GraphicsManager::GetMaxTextureSize() const
+	{
+		return mMaxTextureSize;
 	}
 
 	void GraphicsManager::StartDraw()
 	{
 		glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-		
+		mRenderStats = RenderStats();
 	}
 
 	void GraphicsManager::StopDraw()
 	{
+		mLastRenderStats = mRenderStats;
+		++mFrameCount;
+		if(mbRecordingRenderStats)
+		{
+			RecordRenderStats();
+		}
+
 #ifdef ANDROID
 		 if (eglSwapBuffers(mDisplay, mSurface) != EGL_TRUE)
 		 {
@@ -284,6 +504,85 @@ namespace star
 #endif
 	}
 
+	const RenderStats & GraphicsManager::GetRenderStats() const
+	{
+		return mLastRenderStats;
+	}
+
+	RenderStats & GraphicsManager::GetCurrentRenderStats()
+	{
+		return mRenderStats;
+	}
+
+	uint32 GraphicsManager::GetFrameCount() const
+	{
+		return mFrameCount;
+	}
+
+	void GraphicsManager::StartRenderStatsRecording(const tstring & file,
+		DirectoryMode directory)
+	{
+		StopRenderStatsRecording();
+
+		mRenderStatsFile = file;
+		mRenderStatsDirectory = directory;
+		mRenderStatsRecord.str(tstring());
+		mRecordedFrames = 0;
+		mbRecordingRenderStats = true;
+
+		WriteTextFile(file,
+			_T("frame,drawCalls,textureBinds,sprites,glyphs,quadBatches,")
+			_T("debugPrimitives,bufferUploads,bytesUploaded,")
+			_T("stateChanges,redundantStateChanges\n"),
+			directory);
+	}
+
+	void GraphicsManager::StopRenderStatsRecording()
+	{
+		if(mbRecordingRenderStats)
+		{
+			FlushRenderStatsRecord();
+			mbRecordingRenderStats = false;
+		}
+	}
+
+	bool GraphicsManager::IsRecordingRenderStats() const
+	{
+		return mbRecordingRenderStats;
+	}
+
+	void GraphicsManager::RecordRenderStats()
+	{
+		const RenderStats & stats = mLastRenderStats;
+		mRenderStatsRecord
+			<< mFrameCount << _T(',')
+			<< stats.drawCalls << _T(',')
+			<< stats.textureBinds << _T(',')
+			<< stats.sprites << _T(',')
+			<< stats.glyphs << _T(',')
+			<< stats.quadBatches << _T(',')
+			<< stats.debugPrimitives << _T(',')
+			<< stats.bufferUploads << _T(',')
+			<< stats.bytesUploaded << _T(',')
+			<< stats.stateChanges << _T(',')
+			<< stats.redundantStateChanges << _T('\n');
+
+		if(++mRecordedFrames % RENDER_STATS_RECORD_FLUSH_FRAMES == 0)
+		{
+			FlushRenderStatsRecord();
+		}
+	}
+
+	void GraphicsManager::FlushRenderStatsRecord()
+	{
+		tstring rows(mRenderStatsRecord.str());
+		if(!rows.empty())
+		{
+			AppendTextFile(mRenderStatsFile, rows, mRenderStatsDirectory);
+			mRenderStatsRecord.str(tstring());
+		}
+	}
+
 	void GraphicsManager::Update()
 	{
 		if(SceneManager::GetInstance()->GetActiveScene())
@@ -2,6 +2,7 @@
 
 #include "../defines.h"
 #include "../Helpers/Singleton.h"
+#include <sstream>
 
 #ifdef DESKTOP
 #include <Windows.h>
@@ -14,8 +15,47 @@
 #include <android_native_app_glue.h>
 #endif
 
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 namespace star
 {
+	//Renderer counters of one frame, 
+	//filled by the SpriteBatch and DebugDraw while flushing.
+	struct RenderStats
+	{
+		RenderStats()
+			: drawCalls(0)
+			, textureBinds(0)
+			, sprites(0)
+			, glyphs(0)
+			, quadBatches(0)
+			, debugPrimitives(0)
+			, bufferUploads(0)
+			, bytesUploaded(0)
+			, stateChanges(0)
+			, redundantStateChanges(0)
+		{}
+
+		uint32 drawCalls;
+		uint32 textureBinds;
+		uint32 sprites;
+		uint32 glyphs;
+		//Retained quad ranges, like static sprites and tile layer chunks
+		uint32 quadBatches;
+		uint32 debugPrimitives;
+		uint32 bufferUploads;
+		uint64 bytesUploaded;
+		//GL state calls that went through the GLStateCache,
+		//and the ones it skipped because nothing would change
+		uint32 stateChanges;
+		uint32 redundantStateChanges;
+	};
+
 	class GraphicsManager final : public Singleton<GraphicsManager>
 	{
 	public:
@@ -65,17 +105,73 @@ namespace star
 		void SetVSync(bool VSync);
 		bool GetVSync() const;
 
+		//Instanced drawing needs an OpenGL 3.3 or OpenGL ES 3 context,
+		//only call the instancing functions when this returns true.
+		bool IsInstancingSupported() const;
+		void DrawArraysInstanced(GLenum mode, GLint first,
+			GLsizei count, GLsizei instanceCount) const;
+		void VertexAttribDivisor(GLuint index, GLuint divisor) const;
+
+		//Linked programs can be saved and reloaded as driver specific binaries
+		//with OpenGL 4.1, OpenGL ES 3 or the get_program_binary extensions.
+		bool IsProgramBinarySupported() const;
+		void SetProgramBinaryRetrievable(GLuint program) const;
+		void GetProgramBinary(GLuint program, GLsizei bufferSize,
+			GLsizei* length, GLenum* format, void* binary) const;
+		void ProgramBinary(GLuint program, GLenum format,
+			const void* binary, GLsizei length) const;
+
+		//ETC1, ETC2 and S3TC, see TextureCompression.
+		//Unsupported formats get decompressed on the cpu when loaded.
+		bool IsCompressedTextureFormatSupported(GLenum format) const;
+		//GL_MAX_TEXTURE_SIZE, read once when the context is created
+		int32 GetMaxTextureSize() const;
+
+		//Stats of the last completed frame
+		const RenderStats & GetRenderStats() const;
+		//Stats of the frame that is being drawn, renderers add to these
+		RenderStats & GetCurrentRenderStats();
+		uint32 GetFrameCount() const;
+
+		//Appends the stats of every frame to a csv file until stopped
+		void StartRenderStatsRecording(const tstring & file,
+			DirectoryMode directory = DirectoryMode::internal);
+		void StopRenderStatsRecording();
+		bool IsRecordingRenderStats() const;
+
 	private:
 		GraphicsManager();
 		~GraphicsManager();
 
 		void InitializeOpenGLStates();
+		void InitializeInstancing();
+		void InitializeProgramBinaries();
+		void InitializeCompressedTextures();
+		void RecordRenderStats();
+		void FlushRenderStatsRecord();
 #ifdef DESKTOP
 		bool WGLExtensionSupported(const schar* extension_name);
 		bool InitializeOpenGLFunctors();
 
 		PFNWGLSWAPINTERVALEXTPROC       mWglSwapIntervalEXT;
 		PFNWGLGETSWAPINTERVALEXTPROC    mWglGetSwapIntervalEXT;
+#else
+		//Not declared by the GLES2 headers, loaded when the context is GLES 3
+		typedef void (GL_APIENTRYP PFNGLDRAWARRAYSINSTANCEDPROC)
+			(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+		typedef void (GL_APIENTRYP PFNGLVERTEXATTRIBDIVISORPROC)
+			(GLuint index, GLuint divisor);
+
+		typedef void (GL_APIENTRYP PFNGLGETPROGRAMBINARYPROC)
+			(GLuint program, GLsizei bufferSize, GLsizei* length,
+			GLenum* format, void* binary);
+		typedef void (GL_APIENTRYP PFNGLPROGRAMBINARYPROC)
+			(GLuint program, GLenum format, const void* binary, GLsizei length);
+
+		PFNGLDRAWARRAYSINSTANCEDPROC	mGlDrawArraysInstanced;
+		PFNGLVERTEXATTRIBDIVISORPROC	mGlVertexAttribDivisor;
+		PFNGLGETPROGRAMBINARYPROC		mGlGetProgramBinary;
+		PFNGLPROGRAMBINARYPROC			mGlProgramBinary;
 #endif
 		int32 mHorizontalViewportOffset,
 			mVerticalViewportOffset;
@@ -87,6 +183,23 @@ namespace star
 		vec2 mScreenResolution, mViewportResolution;
 		bool mbHasWindowChanged;
 		bool mIsInitialized;
+		bool mbInstancingSupported;
+		bool mbProgramBinarySupported;
+		bool mbETC1Supported,
+			 mbETC2Supported,
+			 mbS3TCSupported;
+		int32 mMaxTextureSize;
+
+		static const uint32 RENDER_STATS_RECORD_FLUSH_FRAMES = 60;
+
+		RenderStats mRenderStats, mLastRenderStats;
+		uint32 mFrameCount;
+		tstring mRenderStatsFile;
+		DirectoryMode mRenderStatsDirectory;
+		//Recorded rows are written in blocks, not every frame
+		tstringstream mRenderStatsRecord;
+		uint32 mRecordedFrames;
+		bool mbRecordingRenderStats;
 
 #ifdef ANDROID
 		EGLDisplay mDisplay;
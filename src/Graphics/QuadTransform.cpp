@@ -0,0 +1,277 @@
+#include "QuadTransform.h"
+#ifdef STARENGINE_BENCHMARKS
+#include "../Logger.h"
+#include "../Helpers/Math.h"
+#include "../Helpers/Helpers.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define QUAD_TRANSFORM_SSE
+	#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define QUAD_TRANSFORM_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace star
+{
+	void TransformQuadCornersScalar(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		)
+	{
+		for(uint32 i = 0; i < amount; ++i)
+		{
+			const QuadTransformInput & quad = input[i];
+			float32 aw = quad.a * quad.width;
+			float32 bw = quad.b * quad.width;
+			float32 ch = quad.c * quad.height;
+			float32 dh = quad.d * quad.height;
+
+			QuadCorners & corners = output[i];
+			corners.BL.x = quad.tx;
+			corners.BL.y = quad.ty;
+			corners.BR.x = quad.tx + aw;
+			corners.BR.y = quad.ty + bw;
+			corners.TL.x = quad.tx + ch;
+			corners.TL.y = quad.ty + dh;
+			corners.TR.x = corners.BR.x + ch;
+			corners.TR.y = corners.BR.y + dh;
+		}
+	}
+
+#if defined(QUAD_TRANSFORM_SSE)
+	void TransformQuadCorners(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		)
+	{
+		uint32 simdAmount = amount & ~3u;
+		for(uint32 i = 0; i < simdAmount; i += 4)
+		{
+			const float32 * src = reinterpret_cast<const float32*>(input + i);
+
+			//Load 4 quads and transpose them to one register per member
+			__m128 a = _mm_loadu_ps(src);
+			__m128 b = _mm_loadu_ps(src + 8);
+			__m128 c = _mm_loadu_ps(src + 16);
+			__m128 d = _mm_loadu_ps(src + 24);
+			_MM_TRANSPOSE4_PS(a, b, c, d);
+
+			__m128 tx = _mm_loadu_ps(src + 4);
+			__m128 ty = _mm_loadu_ps(src + 12);
+			__m128 w = _mm_loadu_ps(src + 20);
+			__m128 h = _mm_loadu_ps(src + 28);
+			_MM_TRANSPOSE4_PS(tx, ty, w, h);
+
+			__m128 brX = _mm_add_ps(tx, _mm_mul_ps(a, w));
+			__m128 brY = _mm_add_ps(ty, _mm_mul_ps(b, w));
+			__m128 ch = _mm_mul_ps(c, h);
+			__m128 dh = _mm_mul_ps(d, h);
+			__m128 tlX = _mm_add_ps(tx, ch);
+			__m128 tlY = _mm_add_ps(ty, dh);
+			__m128 trX = _mm_add_ps(brX, ch);
+			__m128 trY = _mm_add_ps(brY, dh);
+
+			//Interleave x and y again, quads 0 and 1 in the low,
+			//quads 2 and 3 in the high registers
+			__m128 tlLow = _mm_unpacklo_ps(tlX, tlY);
+			__m128 tlHigh = _mm_unpackhi_ps(tlX, tlY);
+			__m128 trLow = _mm_unpacklo_ps(trX, trY);
+			__m128 trHigh = _mm_unpackhi_ps(trX, trY);
+			__m128 blLow = _mm_unpacklo_ps(tx, ty);
+			__m128 blHigh = _mm_unpackhi_ps(tx, ty);
+			__m128 brLow = _mm_unpacklo_ps(brX, brY);
+			__m128 brHigh = _mm_unpackhi_ps(brX, brY);
+
+			float32 * dst = reinterpret_cast<float32*>(output + i);
+			_mm_storeu_ps(dst, _mm_movelh_ps(tlLow, trLow));
+			_mm_storeu_ps(dst + 4, _mm_movelh_ps(blLow, brLow));
+			_mm_storeu_ps(dst + 8, _mm_movehl_ps(trLow, tlLow));
+			_mm_storeu_ps(dst + 12, _mm_movehl_ps(brLow, blLow));
+			_mm_storeu_ps(dst + 16, _mm_movelh_ps(tlHigh, trHigh));
+			_mm_storeu_ps(dst + 20, _mm_movelh_ps(blHigh, brHigh));
+			_mm_storeu_ps(dst + 24, _mm_movehl_ps(trHigh, tlHigh));
+			_mm_storeu_ps(dst + 28, _mm_movehl_ps(brHigh, blHigh));
+		}
+		TransformQuadCornersScalar(input + simdAmount, amount - simdAmount, output + simdAmount);
+	}
+#elif defined(QUAD_TRANSFORM_NEON)
+	void TransformQuadCorners(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		)
+	{
+		uint32 simdAmount = amount & ~3u;
+		for(uint32 i = 0; i < simdAmount; i += 4)
+		{
+			const float32 * src = reinterpret_cast<const float32*>(input + i);
+
+			//De-interleave 4 quads into one register per member
+			float32x4x4_t first = vld4q_f32(src);
+			float32x4x4_t second = vld4q_f32(src + 16);
+			float32x4x2_t a = vuzpq_f32(first.val[0], second.val[0]);
+			float32x4x2_t b = vuzpq_f32(first.val[1], second.val[1]);
+			float32x4x2_t c = vuzpq_f32(first.val[2], second.val[2]);
+			float32x4x2_t d = vuzpq_f32(first.val[3], second.val[3]);
+			//a.val[0] = a, a.val[1] = tx, b: b/ty, c: c/width, d: d/height
+			float32x4_t tx = a.val[1];
+			float32x4_t ty = b.val[1];
+			float32x4_t w = c.val[1];
+			float32x4_t h = d.val[1];
+
+			float32x4_t brX = vmlaq_f32(tx, a.val[0], w);
+			float32x4_t brY = vmlaq_f32(ty, b.val[0], w);
+			float32x4_t ch = vmulq_f32(c.val[0], h);
+			float32x4_t dh = vmulq_f32(d.val[0], h);
+			float32x4_t tlX = vaddq_f32(tx, ch);
+			float32x4_t tlY = vaddq_f32(ty, dh);
+			float32x4_t trX = vaddq_f32(brX, ch);
+			float32x4_t trY = vaddq_f32(brY, dh);
+
+			float32x4x2_t tl = vzipq_f32(tlX, tlY);
+			float32x4x2_t tr = vzipq_f32(trX, trY);
+			float32x4x2_t bl = vzipq_f32(tx, ty);
+			float32x4x2_t br = vzipq_f32(brX, brY);
+
+			float32 * dst = reinterpret_cast<float32*>(output + i);
+			for(uint32 j = 0; j < 2; ++j)
+			{
+				vst1q_f32(dst, vcombine_f32(vget_low_f32(tl.val[j]), vget_low_f32(tr.val[j])));
+				vst1q_f32(dst + 4, vcombine_f32(vget_low_f32(bl.val[j]), vget_low_f32(br.val[j])));
+				vst1q_f32(dst + 8, vcombine_f32(vget_high_f32(tl.val[j]), vget_high_f32(tr.val[j])));
+				vst1q_f32(dst + 12, vcombine_f32(vget_high_f32(bl.val[j]), vget_high_f32(br.val[j])));
+				dst += 16;
+			}
+		}
+		TransformQuadCornersScalar(input + simdAmount, amount - simdAmount, output + simdAmount);
+	}
+#else
+	void TransformQuadCorners(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		)
+	{
+		TransformQuadCornersScalar(input, amount, output);
+	}
+#endif
+
+#ifdef STARENGINE_BENCHMARKS
+	void BenchmarkQuadTransform(uint32 quadAmount, uint32 iterations)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		//Same random sprites every run
+		uint32 seed(12345);
+		auto random = [&seed]() -> float32
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return float32(seed >> 8) / float32(1 << 24);
+		};
+
+		std::vector<mat4> worlds(quadAmount);
+		std::vector<vec2> sizes(quadAmount);
+		for(uint32 i = 0; i < quadAmount; ++i)
+		{
+			float32 angle = random() * 6.2831853f;
+			float32 scaleX = 0.5f + random() * 2.0f;
+			float32 scaleY = 0.5f + random() * 2.0f;
+			mat4 & world = worlds[i];
+			world = mat4();
+			world[0][0] = std::cos(angle) * scaleX;
+			world[0][1] = std::sin(angle) * scaleX;
+			world[1][0] = -std::sin(angle) * scaleY;
+			world[1][1] = std::cos(angle) * scaleY;
+			world[3][0] = random() * 1920.0f;
+			world[3][1] = random() * 1080.0f;
+			world[3][2] = random();
+			sizes[i] = vec2(8.0f + random() * 120.0f, 8.0f + random() * 120.0f);
+		}
+
+		std::vector<QuadCorners> reference(quadAmount);
+		std::vector<QuadCorners> scalar(quadAmount);
+		std::vector<QuadCorners> simd(quadAmount);
+		std::vector<QuadTransformInput> inputs(quadAmount);
+
+		//The path CreateSpriteQuads used before the kernels
+		auto start = Clock::now();
+		for(uint32 it = 0; it < iterations; ++it)
+		{
+			for(uint32 i = 0; i < quadAmount; ++i)
+			{
+				mat4 transformMat = Transpose(worlds[i]);
+				vec4 TL(0, sizes[i].y, 0, 1), TR(sizes[i].x, sizes[i].y, 0, 1),
+					 BL(0, 0, 0, 1), BR(sizes[i].x, 0, 0, 1);
+				Mul(TL, transformMat, TL);
+				Mul(TR, transformMat, TR);
+				Mul(BL, transformMat, BL);
+				Mul(BR, transformMat, BR);
+				QuadCorners & corners = reference[i];
+				corners.TL = vec2(TL.x, TL.y);
+				corners.TR = vec2(TR.x, TR.y);
+				corners.BL = vec2(BL.x, BL.y);
+				corners.BR = vec2(BR.x, BR.y);
+			}
+		}
+		auto matrixTime = Clock::now() - start;
+
+		std::chrono::high_resolution_clock::duration setupTime(0), scalarTime(0), simdTime(0);
+		for(uint32 it = 0; it < iterations; ++it)
+		{
+			start = Clock::now();
+			for(uint32 i = 0; i < quadAmount; ++i)
+			{
+				SetQuadTransform(worlds[i], sizes[i].x, sizes[i].y, inputs[i]);
+			}
+			auto setupEnd = Clock::now();
+			TransformQuadCornersScalar(&inputs[0], quadAmount, &scalar[0]);
+			auto scalarEnd = Clock::now();
+			TransformQuadCorners(&inputs[0], quadAmount, &simd[0]);
+			auto simdEnd = Clock::now();
+
+			setupTime += setupEnd - start;
+			scalarTime += scalarEnd - setupEnd;
+			simdTime += simdEnd - scalarEnd;
+		}
+
+		float32 scalarError(0), simdError(0);
+		for(uint32 i = 0; i < quadAmount; ++i)
+		{
+			const vec2 * ref = &reference[i].TL;
+			const vec2 * sc = &scalar[i].TL;
+			const vec2 * si = &simd[i].TL;
+			for(uint32 c = 0; c < 4; ++c)
+			{
+				scalarError = std::max(scalarError, std::max(
+					std::abs(ref[c].x - sc[c].x), std::abs(ref[c].y - sc[c].y)));
+				simdError = std::max(simdError, std::max(
+					std::abs(ref[c].x - si[c].x), std::abs(ref[c].y - si[c].y)));
+			}
+		}
+
+		auto toMs = [iterations](std::chrono::high_resolution_clock::duration time) -> tstring
+		{
+			return string_cast<tstring>(
+				std::chrono::duration<float64, std::milli>(time).count() / iterations);
+		};
+
+		LOG(LogLevel::Info,
+			_T("BenchmarkQuadTransform: ") + string_cast<tstring>(quadAmount) +
+			_T(" quads, ms per iteration: matrix path ") + toMs(matrixTime) +
+			_T(", setup ") + toMs(setupTime) +
+			_T(", scalar kernel ") + toMs(scalarTime) +
+			_T(", simd kernel ") + toMs(simdTime) +
+			_T(". Largest difference: scalar ") + string_cast<tstring>(scalarError) +
+			_T(", simd ") + string_cast<tstring>(simdError),
+			STARENGINE_LOG_TAG);
+	}
+#endif
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../defines.h"
+
+namespace star
+{
+	//Compact 2D affine transform of a quad with its size.
+	//A corner (x, y) of the quad ends up at
+	//(a * x + c * y + tx, b * x + d * y + ty).
+	//The members are laid out so 4 quads can be loaded and
+	//transposed into SIMD registers at once.
+	struct QuadTransformInput
+	{
+		float32 a, b, c, d;
+		float32 tx, ty, width, height;
+	};
+
+	//Transformed corners of one quad, in SpriteBatch vertex order
+	struct QuadCorners
+	{
+		vec2 TL, TR, BL, BR;
+	};
+
+	//Fills a QuadTransformInput from a (column major) world matrix.
+	//The offset is applied in local space before the world matrix.
+	//Inlined, as it gets called once for every sprite and glyph.
+	inline void SetQuadTransform(
+		const mat4 & world,
+		float32 width,
+		float32 height,
+		QuadTransformInput & input,
+		float32 offsetX = 0.0f,
+		float32 offsetY = 0.0f
+		)
+	{
+		input.a = world[0][0];
+		input.b = world[0][1];
+		input.c = world[1][0];
+		input.d = world[1][1];
+		input.tx = world[0][0] * offsetX + world[1][0] * offsetY + world[3][0];
+		input.ty = world[0][1] * offsetX + world[1][1] * offsetY + world[3][1];
+		input.width = width;
+		input.height = height;
+	}
+
+	//Transforms the 4 corners of every quad.
+	//Uses SSE or NEON when available, with a scalar fallback.
+	void TransformQuadCorners(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		);
+
+	//Reference implementation, also used for the remaining quads
+	//that don't fill a complete SIMD batch.
+	void TransformQuadCornersScalar(
+		const QuadTransformInput * input,
+		uint32 amount,
+		QuadCorners * output
+		);
+
+#ifdef STARENGINE_BENCHMARKS
+	//Times the old Transpose + 4x Mul path of the SpriteBatch against
+	//the scalar and the SIMD kernel on random rotated and scaled quads,
+	//and logs the average time per iteration and the largest difference.
+	void BenchmarkQuadTransform(uint32 quadAmount = 10000, uint32 iterations = 500);
+#endif
+}
@@ -2,6 +2,10 @@
 #include "../Logger.h"
 #include "../Helpers/Helpers.h"
 #include "../StarEngine.h"
+#include "GraphicsManager.h"
+#include "GLStateCache.h"
+#include <vector>
+#include <cstring>
 
 namespace star
 {
@@ -23,12 +27,22 @@ namespace star
 
 	Shader::~Shader()
 	{
-		glDeleteProgram(m_ProgramID);
+		GLStateCache::GetInstance()->DeleteProgram(m_ProgramID);
 	}
 
 	bool Shader::Init(const tstring& vsFile, const tstring& fsFile)
 	{	
-		if(!CompileShader(&m_VertexShader, GL_VERTEX_SHADER, vsFile ))
+		sstring vsSource, fsSource;
+		ReadShaderSource(vsFile, vsSource);
+		ReadShaderSource(fsFile, fsSource);
+
+		uint64 sourceHash(HashShaderSource(vsSource.c_str(), fsSource.c_str()));
+		if(LoadProgramBinary(sourceHash))
+		{
+			return true;
+		}
+
+		if(!CompileShader(&m_VertexShader, GL_VERTEX_SHADER, vsSource.c_str()))
 		{
 			LOG(LogLevel::Error, 
 				_T("Shader::Init: \
@@ -37,7 +51,7 @@ Failed To load Vertex Shader ") + vsFile,
 			return false;
 		}
 		
-		if(!CompileShader(&m_FragmentShader, GL_FRAGMENT_SHADER, fsFile))
+		if(!CompileShader(&m_FragmentShader, GL_FRAGMENT_SHADER, fsSource.c_str()))
 		{
 			LOG(LogLevel::Error, 
 				 _T("Shader::Init: \
@@ -46,11 +60,22 @@ Failed To load Fragment Shader ") + fsFile,
 			return false;
 		}
 		
-		return GLInit();
+		if(!GLInit())
+		{
+			return false;
+		}
+		SaveProgramBinary(sourceHash);
+		return true;
 	}
 
 	bool Shader::Init(const GLchar* inlineVert, const GLchar* inlineFrag)
 	{
+		uint64 sourceHash(HashShaderSource(inlineVert, inlineFrag));
+		if(LoadProgramBinary(sourceHash))
+		{
+			return true;
+		}
+
 		if(!CompileShader(&m_VertexShader, GL_VERTEX_SHADER, inlineVert ))
 		{
 			LOG(LogLevel::Error, 
@@ -68,7 +93,149 @@ Failed To load Fragment Shader ") + string_cast<tstring>(inlineFrag),
 					STARENGINE_LOG_TAG);
 			return false;
 		}
-		return GLInit();
+
+		if(!GLInit())
+		{
+			return false;
+		}
+		SaveProgramBinary(sourceHash);
+		return true;
+	}
+
+	bool Shader::LoadProgramBinary(uint64 sourceHash)
+	{
+		if(!GraphicsManager::GetInstance()->IsProgramBinarySupported())
+		{
+			return false;
+		}
+
+		schar * buffer(nullptr);
+		uint32 size(0);
+		if(!ReadBinaryFileSafe(GetProgramBinaryFile(sourceHash), buffer, size,
+			DirectoryMode::internal, false))
+		{
+			return false;
+		}
+
+		bool loaded(false);
+		ProgramBinaryHeader header;
+		if(size >= sizeof(ProgramBinaryHeader))
+		{
+			memcpy(&header, buffer, sizeof(ProgramBinaryHeader));
+		}
+		if(size >= sizeof(ProgramBinaryHeader)
+			&& header.magic == PROGRAM_BINARY_MAGIC
+			&& header.sourceHash == sourceHash
+			&& header.driverHash == GetDriverHash()
+			&& header.length == size - sizeof(ProgramBinaryHeader))
+		{
+			m_ProgramID = glCreateProgram();
+			GraphicsManager::GetInstance()->ProgramBinary(m_ProgramID, header.format,
+				buffer + sizeof(ProgramBinaryHeader), header.length);
+
+			//The driver can still reject a binary, after an update for example
+			GLint status(0);
+			glGetProgramiv(m_ProgramID, GL_LINK_STATUS, &status);
+			if(status)
+			{
+				loaded = true;
+			}
+			else
+			{
+				GLStateCache::GetInstance()->DeleteProgram(m_ProgramID);
+				m_ProgramID = 0;
+			}
+		}
+		delete [] buffer;
+
+		if(!loaded)
+		{
+			LOG(LogLevel::Info,
+				_T("Shader::LoadProgramBinary: Cached program binary is stale, \
+compiling from source."), STARENGINE_LOG_TAG);
+		}
+		return loaded;
+	}
+
+	void Shader::SaveProgramBinary(uint64 sourceHash) const
+	{
+		if(!GraphicsManager::GetInstance()->IsProgramBinarySupported())
+		{
+			return;
+		}
+
+		GLint length(0);
+		glGetProgramiv(m_ProgramID, GL_PROGRAM_BINARY_LENGTH, &length);
+		if(length <= 0)
+		{
+			return;
+		}
+
+		std::vector<schar> buffer(sizeof(ProgramBinaryHeader) + length);
+		GLsizei written(0);
+		GLenum format(0);
+		GraphicsManager::GetInstance()->GetProgramBinary(m_ProgramID, length,
+			&written, &format, &buffer[sizeof(ProgramBinaryHeader)]);
+		if(written <= 0)
+		{
+			return;
+		}
+
+		ProgramBinaryHeader header;
+		header.magic = PROGRAM_BINARY_MAGIC;
+		header.format = format;
+		header.sourceHash = sourceHash;
+		header.driverHash = GetDriverHash();
+		header.length = written;
+		header.padding = 0;
+		memcpy(&buffer[0], &header, sizeof(ProgramBinaryHeader));
+
+		WriteBinaryFile(GetProgramBinaryFile(sourceHash), &buffer[0],
+			sizeof(ProgramBinaryHeader) + written, DirectoryMode::internal);
+	}
+
+	uint64 Shader::HashShaderSource(const GLchar* vertex, const GLchar* fragment)
+	{
+		//64 bit FNV-1a, the separator keeps "ab" + "c" apart from "a" + "bc"
+		uint64 hash(14695981039346656037ULL);
+		for(const GLchar* c = vertex; *c != 0; ++c)
+		{
+			hash = (hash ^ uint8(*c)) * 1099511628211ULL;
+		}
+		hash = (hash ^ 0xFF) * 1099511628211ULL;
+		for(const GLchar* c = fragment; *c != 0; ++c)
+		{
+			hash = (hash ^ uint8(*c)) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	uint64 Shader::GetDriverHash()
+	{
+		const GLubyte* strings[] = 
+		{
+			glGetString(GL_VENDOR),
+			glGetString(GL_RENDERER),
+			glGetString(GL_VERSION)
+		};
+
+		uint64 hash(14695981039346656037ULL);
+		for(const GLubyte* str : strings)
+		{
+			for(const GLubyte* c = str; c != nullptr && *c != 0; ++c)
+			{
+				hash = (hash ^ *c) * 1099511628211ULL;
+			}
+			hash = (hash ^ 0xFF) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	tstring Shader::GetProgramBinaryFile(uint64 sourceHash)
+	{
+		tstringstream name;
+		name << _T("shader_") << std::hex << sourceHash << _T(".bin");
+		return name.str();
 	}
 
 	bool Shader::GLInit()
@@ -85,6 +252,7 @@ Failed To load Fragment Shader ") + string_cast<tstring>(inlineFrag),
 		glAttachShader(m_ProgramID, m_VertexShader);
 		glAttachShader(m_ProgramID, m_FragmentShader);
 
+		GraphicsManager::GetInstance()->SetProgramBinaryRetrievable(m_ProgramID);
 		glLinkProgram(m_ProgramID);
 		GLint status;
 		glGetProgramiv(m_ProgramID, GL_LINK_STATUS, &status);
@@ -117,7 +285,7 @@ Failed To load Fragment Shader ") + string_cast<tstring>(inlineFrag),
 				
 			}
 #endif
-			glDeleteProgram(m_ProgramID);
+			GLStateCache::GetInstance()->DeleteProgram(m_ProgramID);
 			return false;
 		}
 		glDeleteShader(m_VertexShader);
@@ -126,24 +294,12 @@ Failed To load Fragment Shader ") + string_cast<tstring>(inlineFrag),
 		return true;
 	}
 
-	bool Shader::CompileShader(GLuint* shader, GLenum type, const tstring& file)
+	void Shader::ReadShaderSource(const tstring& file, sstring& source)
 	{		
-		schar* source;
-
 		uint32 size;
 		schar * buffer = ReadBinaryFile(file, size);
-		source = new schar[size+1];
-		memcpy(source, buffer, size);
-
+		source.assign(buffer, size);
 		delete [] buffer;
-
-		source[size] = '\0';
-
-		bool returnValue(CompileShader(shader, type, source));
-
-		delete[] source;
-
-		return returnValue;
 	}
 
 	bool Shader::CompileShader(GLuint* shader, GLenum type, const GLchar* inlineFile)
@@ -232,12 +388,12 @@ Could not compile shader of type ")
 
 	void Shader::Bind()
 	{
-		glUseProgram(m_ProgramID);
+		GLStateCache::GetInstance()->UseProgram(m_ProgramID);
 	}
 
 	void Shader::Unbind()
 	{
-		glUseProgram(0);
+		GLStateCache::GetInstance()->UseProgram(0);
 	}
 
 	const GLuint Shader::GetProgramID() const
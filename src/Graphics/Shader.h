@@ -97,15 +97,11 @@ namespace star
 		bool Init(const GLchar* inlineVert, const GLchar* inlineFrag);
 
 		/// <summary>
-		/// Compiles the shader.
+		/// Reads the source of a shader file.
 		/// </summary>
-		/// <param name="shader">The shader to compile.</param>
-		/// <param name="type">
-		/// The type of the shader. Example: GL_VERTEX_SHADER
-		/// </param>
-		/// <param name="file">The file to compile.</param>
-		/// <returns>True if the compilation was succesfull.</returns>
-		bool CompileShader(GLuint* shader, GLenum type, const tstring& file);
+		/// <param name="file">The shader file.</param>
+		/// <param name="source">Output parameter for the source.</param>
+		void ReadShaderSource(const tstring& file, sstring& source);
 		/// <summary>
 		/// Compiles the shader.
 		/// </summary>
@@ -128,6 +124,40 @@ namespace star
 		/// <returns>True if everything was succesfull.</returns>
 		bool GLCompileShader();
 
+		/// <summary>
+		/// Creates the program from a cached program binary.
+		/// </summary>
+		/// <param name="sourceHash">Hash of the shader sources.</param>
+		/// <returns>True if the cache was valid for these sources and this driver.</returns>
+		bool LoadProgramBinary(uint64 sourceHash);
+		/// <summary>
+		/// Stores the linked program as a program binary in the internal directory.
+		/// </summary>
+		/// <param name="sourceHash">Hash of the shader sources.</param>
+		void SaveProgramBinary(uint64 sourceHash) const;
+		/// <summary>
+		/// Hashes the vertex and fragment shader sources together.
+		/// </summary>
+		static uint64 HashShaderSource(const GLchar* vertex, const GLchar* fragment);
+		/// <summary>
+		/// Hashes the vendor, renderer and version strings of the driver.
+		/// A binary is only valid for the driver that created it.
+		/// </summary>
+		static uint64 GetDriverHash();
+		static tstring GetProgramBinaryFile(uint64 sourceHash);
+
+		struct ProgramBinaryHeader
+		{
+			uint32 magic;
+			uint32 format;
+			uint64 sourceHash;
+			uint64 driverHash;
+			uint32 length;
+			uint32 padding;
+		};
+
+		static const uint32 PROGRAM_BINARY_MAGIC = 0x53504231;
+
 		GLuint m_ProgramID;
 		GLuint m_VertexShader;
 		GLuint m_FragmentShader;
@@ -2,6 +2,7 @@
 #include "../Objects/Object.h"
 #include "../Scenes/SceneManager.h"
 #include "GraphicsManager.h"
+#include "GLStateCache.h"
 #include "../Components/CameraComponent.h"
 #include "../Objects/FreeCamera.h"
 #include "../Scenes/BaseScene.h"
@@ -9,6 +10,7 @@
 #include "../Helpers/Math.h"
 #include "ScaleSystem.h"
 #include "Font.h"
+#include <cstddef>
 
 namespace star
 {
@@ -16,24 +18,106 @@ namespace star
 		: Singleton<SpriteBatch>()
 		, m_SpriteQueue()
 		, m_TextQueue()
+		, m_SortEntries()
+		, m_SortEntriesBuffer()
+		, m_SortedSpriteQueue()
+		, m_StaticSpriteQueue()
+		, m_StaticSpriteStates()
+		, m_StaticBatches()
+		, m_StaticVertexBuffer()
+		, m_StaticVertexBufferID(0)
+		, m_StaticSortingMode(SpriteSortingMode::BackToFront)
+		, m_bStaticInVertexBuffer(false)
+		, m_bStaticUploadPending(false)
+		, m_QuadBatchInfoQueue()
+		, m_QuadBatchQueue()
+		, m_SourceVertexBufferID(0)
+		, m_SourceVertices(nullptr)
+		, m_FirstTextQuad(0)
+		, m_QueueSnapshot(0)
+		, m_pPresentSnapshot(nullptr)
+		, m_RenderThread()
+		, m_RenderMutex()
+		, m_RenderCondition()
+		, m_pBuildSnapshot(nullptr)
+		, m_bStopRenderThread(false)
+		, m_bUseRenderThread(false)
 		, m_VertexBuffer()
-		, m_UvCoordBuffer()
-		, m_IsHUDBuffer()
-		, m_ColorBuffer()
+		, m_QuadInputs()
+		, m_QuadCorners()
+		, m_VertexID(0)
+		, m_UVID(0)
+		, m_IsHUDID(0)
+		, m_VertexAttribMask(0)
+		, m_CurrentVertexBuffer(0)
+		, m_IndexBuffer()
+		, m_IndexBufferID(0)
+		, m_CurrentQuadPage(0)
+		, m_bUseVertexBuffers(true)
 		, m_TextureSamplerID(0)
 		, m_ColorID(0)
 		, m_ScalingID(0)
 		, m_ViewInverseID(0)
 		, m_ProjectionID(0)
 		, m_ShaderPtr(nullptr)
+		, m_InstancedShaderPtr(nullptr)
+		, m_InstanceCornerID(0)
+		, m_InstanceAxesID(0)
+		, m_InstanceOriginID(0)
+		, m_InstanceUVID(0)
+		, m_InstanceColorID(0)
+		, m_InstanceIsHUDID(0)
+		, m_InstanceTextureSamplerID(0)
+		, m_InstanceScalingID(0)
+		, m_InstanceViewInverseID(0)
+		, m_InstanceProjectionID(0)
+		, m_InstanceAttribMask(0)
+		, m_CornerBufferID(0)
+		, m_CurrentInstanceBuffer(0)
+		, m_InstanceBuffer()
+		, m_bInstancingEnabled(true)
+		, m_bInstancedFrame(false)
+		, m_bStreamingFrame(true)
+		, m_FrameSortingMode(SpriteSortingMode::BackToFront)
+		, m_bInstancedProgramBound(false)
 		, m_SpriteSortingMode(SpriteSortingMode::BackToFront)
 	{
-
+		for(uint32 i = 0; i < VERTEX_BUFFER_COUNT; ++i)
+		{
+			m_VertexBufferIDs[i] = 0;
+			m_VertexBufferSizes[i] = 0;
+			m_InstanceBufferIDs[i] = 0;
+			m_InstanceBufferSizes[i] = 0;
+		}
 	}
 	
 	SpriteBatch::~SpriteBatch(void)
 	{
+		StopRenderThread();
+		if(m_VertexBufferIDs[0] != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(
+				VERTEX_BUFFER_COUNT, m_VertexBufferIDs);
+		}
+		if(m_IndexBufferID != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(1, &m_IndexBufferID);
+		}
+		if(m_StaticVertexBufferID != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(1, &m_StaticVertexBufferID);
+		}
+		if(m_InstanceBufferIDs[0] != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(
+				VERTEX_BUFFER_COUNT, m_InstanceBufferIDs);
+		}
+		if(m_CornerBufferID != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(1, &m_CornerBufferID);
+		}
 		delete m_ShaderPtr;
+		delete m_InstancedShaderPtr;
 	}
 
 	void SpriteBatch::Initialize()
@@ -49,244 +133,970 @@ namespace star
 		m_IsHUDID = m_ShaderPtr->GetAttribLocation("isHUD");
 		m_ColorID = m_ShaderPtr->GetAttribLocation("colorMultiplier");
 
+		const GLuint vertexAttributes[] = 
+		{
+			m_VertexID,
+			m_UVID,
+			m_IsHUDID,
+			m_ColorID
+		};
+		m_VertexAttribMask = GLStateCache::CreateVertexAttribMask(vertexAttributes, 4);
+
 		m_TextureSamplerID = m_ShaderPtr->GetUniformLocation("textureSampler");
 		m_ScalingID = m_ShaderPtr->GetUniformLocation("scaleMatrix");
 		m_ViewInverseID = m_ShaderPtr->GetUniformLocation("viewInverseMatrix");
 		m_ProjectionID = m_ShaderPtr->GetUniformLocation("projectionMatrix");
+
+		glGenBuffers(VERTEX_BUFFER_COUNT, m_VertexBufferIDs);
+		//Created up front, so the render thread knows its ID
+		glGenBuffers(1, &m_StaticVertexBufferID);
+		CreateIndexBuffer();
+		OPENGL_LOG();
+
+		if(GraphicsManager::GetInstance()->IsInstancingSupported())
+		{
+			InitializeInstancing();
+		}
+	}
+
+	void SpriteBatch::InitializeInstancing()
+	{
+		//Same transforms as the sprite and DebugDraw shaders, but the quad
+		//corners are calculated from the instance record instead of read per vertex.
+		static const GLchar* vertexShader = "\
+			uniform mat4 scaleMatrix;\
+			uniform mat4 viewInverseMatrix;\
+			uniform mat4 projectionMatrix;\
+			attribute vec2 corner;\
+			attribute vec4 axes;\
+			attribute vec3 origin;\
+			attribute vec4 uvRect;\
+			attribute vec4 colorMultiplier;\
+			attribute float isHUD;\
+			varying vec2 textureCoordinate;\
+			varying vec4 multiplier;\
+			void main()\
+			{\
+			  vec4 position = vec4(origin.xy + axes.xy * corner.x + axes.zw * corner.y, origin.z, 1.0);\
+			  textureCoordinate = mix(uvRect.xy, uvRect.zw, corner);\
+			  multiplier = colorMultiplier;\
+			  position *= scaleMatrix;\
+			  position *= projectionMatrix;\
+			  if(isHUD < 0.5)\
+			  {\
+			    position *= viewInverseMatrix;\
+			  }\
+			  gl_Position = position;\
+			}\
+			";
+
+		static const GLchar* fragmentShader = "\
+			precision mediump float;\
+			uniform sampler2D textureSampler;\
+			varying vec2 textureCoordinate;\
+			varying vec4 multiplier;\
+			void main()\
+			{\
+			  gl_FragColor = texture2D(textureSampler, textureCoordinate) * multiplier;\
+			}\
+			";
+
+		m_InstancedShaderPtr = new Shader(vertexShader, fragmentShader);
+
+		m_InstanceCornerID = m_InstancedShaderPtr->GetAttribLocation("corner");
+		m_InstanceAxesID = m_InstancedShaderPtr->GetAttribLocation("axes");
+		m_InstanceOriginID = m_InstancedShaderPtr->GetAttribLocation("origin");
+		m_InstanceUVID = m_InstancedShaderPtr->GetAttribLocation("uvRect");
+		m_InstanceColorID = m_InstancedShaderPtr->GetAttribLocation("colorMultiplier");
+		m_InstanceIsHUDID = m_InstancedShaderPtr->GetAttribLocation("isHUD");
+
+		const GLuint instanceAttributes[] = 
+		{
+			m_InstanceCornerID,
+			m_InstanceAxesID,
+			m_InstanceOriginID,
+			m_InstanceUVID,
+			m_InstanceColorID,
+			m_InstanceIsHUDID
+		};
+		m_InstanceAttribMask = GLStateCache::CreateVertexAttribMask(instanceAttributes, 6);
+
+		m_InstanceTextureSamplerID = m_InstancedShaderPtr->GetUniformLocation("textureSampler");
+		m_InstanceScalingID = m_InstancedShaderPtr->GetUniformLocation("scaleMatrix");
+		m_InstanceViewInverseID = m_InstancedShaderPtr->GetUniformLocation("viewInverseMatrix");
+		m_InstanceProjectionID = m_InstancedShaderPtr->GetUniformLocation("projectionMatrix");
+
+		//TL, TR, BL, BR drawn as a triangle strip
+		const float32 corners[] = 
+		{
+			0.0f, 1.0f,
+			1.0f, 1.0f,
+			0.0f, 0.0f,
+			1.0f, 0.0f
+		};
+		glGenBuffers(1, &m_CornerBufferID);
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, m_CornerBufferID);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, 0);
+
+		glGenBuffers(VERTEX_BUFFER_COUNT, m_InstanceBufferIDs);
+		OPENGL_LOG();
+	}
+
+	void SpriteBatch::CreateIndexBuffer()
+	{
+		//Every quad is stored as TL, TR, BL, BR.
+		//This index buffer is shared by all quads and never changes.
+		m_IndexBuffer.clear();
+		m_IndexBuffer.reserve(MAX_QUADS_PER_DRAW * INDICES_PER_QUAD);
+		for(uint32 i = 0; i < MAX_QUADS_PER_DRAW; ++i)
+		{
+			uint16 vertex = uint16(i * VERTICES_PER_QUAD);
+			m_IndexBuffer.push_back(vertex);
+			m_IndexBuffer.push_back(vertex + 1);
+			m_IndexBuffer.push_back(vertex + 2);
+			m_IndexBuffer.push_back(vertex + 1);
+			m_IndexBuffer.push_back(vertex + 3);
+			m_IndexBuffer.push_back(vertex + 2);
+		}
+
+		glGenBuffers(1, &m_IndexBufferID);
+		GLStateCache::GetInstance()->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBufferID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer.size() * sizeof(uint16),
+			&m_IndexBuffer.at(0), GL_STATIC_DRAW);
+		GLStateCache::GetInstance()->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	void SpriteBatch::Flush()
 	{
-		Begin();
-		DrawSprites();
+		//A frame that is still waiting goes first
+		Present();
 
-		//Clear vertex, uv, color and isHud buffer
-		m_VertexBuffer.clear();
-		m_UvCoordBuffer.clear();
-		m_IsHUDBuffer.clear();
-		m_ColorBuffer.clear();
+		RenderSnapshot& snapshot = m_Snapshots[m_QueueSnapshot];
+		CaptureSnapshot(snapshot);
+		if(!m_bUseRenderThread)
+		{
+			BuildFrame(snapshot);
+			DrawFrame(snapshot);
+			return;
+		}
+
+		StartRenderThread();
+		{
+			std::lock_guard<std::mutex> lock(m_RenderMutex);
+			m_pBuildSnapshot = &snapshot;
+		}
+		m_RenderCondition.notify_all();
+		m_pPresentSnapshot = &snapshot;
+		m_QueueSnapshot = (m_QueueSnapshot + 1) % SNAPSHOT_COUNT;
+	}
+
+	void SpriteBatch::Present()
+	{
+		if(m_pPresentSnapshot == nullptr)
+		{
+			return;
+		}
+		WaitForRenderThread();
+		const RenderSnapshot& snapshot = *m_pPresentSnapshot;
+		m_pPresentSnapshot = nullptr;
+		DrawFrame(snapshot);
+	}
+
+	void SpriteBatch::DiscardPendingFrame()
+	{
+		if(m_pPresentSnapshot == nullptr)
+		{
+			return;
+		}
+		WaitForRenderThread();
+		m_pPresentSnapshot = nullptr;
+		End();
+	}
+
+	void SpriteBatch::CaptureSnapshot(RenderSnapshot& snapshot)
+	{
+		//After this the queued pointers aren't needed anymore,
+		//the components are free to change during the next update.
+		snapshot.sortingMode = m_SpriteSortingMode;
+		snapshot.bUseVertexBuffers = m_bUseVertexBuffers;
+		snapshot.bInstanced = IsInstancingActive();
+
+		float32 scaleValue = ScaleSystem::GetInstance()->GetScale();
+		snapshot.scaleMatrix = Scale(scaleValue, scaleValue, 0);
+		snapshot.viewInverseMatrix = GraphicsManager::GetInstance()->GetViewInverseMatrix();
+		//The camera is blended like the sprites, else they judder against it
+		BaseScene* scene = SceneManager::GetInstance()->GetActiveScene();
+		if(scene != nullptr && scene->GetActiveCamera() != nullptr)
+		{
+			snapshot.viewInverseMatrix = scene->GetActiveCamera()
+				->GetComponent<CameraComponent>()->GetInterpolatedViewInverse();
+		}
+		snapshot.projectionMatrix = GraphicsManager::GetInstance()->GetProjectionMatrix();
 
-		DrawTextSprites();
+		//Static sprites are cached, they're drawn where the last step left them
+		CaptureSprites(m_SpriteQueue, snapshot.sprites, true);
+		CaptureSprites(m_StaticSpriteQueue, snapshot.staticSprites, false);
 
+		snapshot.texts.clear();
+		snapshot.glyphs.clear();
+		snapshot.glyphCorners.clear();
+		for(const TextInfo* text : m_TextQueue)
+		{
+			TextRecord record;
+			record.textureID = text->font->GetTextureID();
+			record.colorMultiplier = text->colorMultiplier;
+			record.depth = text->worldMatrix[3][2];
+			record.bIsHud = text->bIsHud;
+			record.firstGlyph = snapshot.glyphs.size();
+			record.glyphCount = text->glyphs.size();
+			snapshot.texts.push_back(record);
+
+			snapshot.glyphs.insert(snapshot.glyphs.end(),
+				text->glyphs.begin(), text->glyphs.end());
+			snapshot.glyphCorners.insert(snapshot.glyphCorners.end(),
+				text->worldCorners.begin(), text->worldCorners.begin() + record.glyphCount);
+		}
+
+		snapshot.quadBatches.clear();
+		for(const QuadBatchInfo* batch : m_QuadBatchInfoQueue)
+		{
+			snapshot.quadBatches.push_back(*batch);
+		}
+
+		m_SpriteQueue.clear();
+		m_StaticSpriteQueue.clear();
+		m_TextQueue.clear();
+		m_QuadBatchInfoQueue.clear();
+	}
+
+	void SpriteBatch::CaptureSprites(const std::vector<const SpriteInfo*>& queue,
+		std::vector<SpriteRecord>& records, bool bInterpolate) const
+	{
+		records.resize(queue.size());
+		for(uint32 i = 0; i < queue.size(); ++i)
+		{
+			const SpriteInfo* sprite = queue[i];
+			SpriteRecord& record = records[i];
+			record.worldMatrix = bInterpolate
+				? sprite->transformPtr->GetInterpolatedWorldMatrix()
+				: sprite->transformPtr->GetWorldMatrix();
+			record.uvCoords = sprite->uvCoords;
+			record.colorMultiplier = sprite->colorMultiplier;
+			record.vertices = sprite->vertices;
+			record.textureID = sprite->textureID;
+			record.layer = sprite->transformPtr->GetWorldPosition().l;
+			record.bIsHud = sprite->bIsHud;
+			record.source = sprite;
+			record.version = sprite->version;
+			record.transformVersion = sprite->transformPtr->GetVersion();
+		}
+	}
+
+	void SpriteBatch::BuildFrame(RenderSnapshot& snapshot)
+	{
+		//[NOTE]	Runs on the render thread when it's enabled,
+		//			so no GL calls, logging or render stats in here.
+		m_bInstancedFrame = snapshot.bInstanced;
+		m_bStreamingFrame = snapshot.bUseVertexBuffers;
+		m_FrameSortingMode = snapshot.sortingMode;
+
+		//Static sprites have their own cached buffer
+		if(!IsStaticCacheValid(snapshot.staticSprites))
+		{
+			RebuildStaticSprites(snapshot.staticSprites);
+		}
+		QueueQuadBatches(snapshot.quadBatches);
+
+		//Create Vertexbuffer, sprites first and text behind it
+		SortSprites(snapshot.sprites, m_FrameSortingMode);
+		if(m_bInstancedFrame)
+		{
+			CreateSpriteInstances(snapshot.sprites);
+			m_FirstTextQuad = 0;
+		}
+		else
+		{
+			CreateSpriteQuads(snapshot.sprites);
+			m_FirstTextQuad = snapshot.sprites.size();
+		}
+		CreateTextQuads(snapshot);
+	}
+
+	void SpriteBatch::DrawFrame(const RenderSnapshot& snapshot)
+	{
+		RenderStats& stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		stats.sprites += snapshot.sprites.size() + snapshot.staticSprites.size();
+		stats.glyphs += snapshot.glyphs.size();
+
+		Begin(snapshot);
+		DrawSprites(snapshot.sprites);
+		DrawTextSprites(snapshot.texts);
 		End();
 	}
+
+	void SpriteBatch::StartRenderThread()
+	{
+		if(m_RenderThread.joinable())
+		{
+			return;
+		}
+		m_bStopRenderThread = false;
+		m_RenderThread = std::thread(&SpriteBatch::RenderThreadLoop, this);
+	}
+
+	void SpriteBatch::StopRenderThread()
+	{
+		if(!m_RenderThread.joinable())
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_RenderMutex);
+			m_bStopRenderThread = true;
+		}
+		m_RenderCondition.notify_all();
+		m_RenderThread.join();
+	}
+
+	void SpriteBatch::RenderThreadLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_RenderMutex);
+		for(;;)
+		{
+			m_RenderCondition.wait(lock, [this]()
+			{
+				return m_bStopRenderThread || m_pBuildSnapshot != nullptr;
+			});
+			//A requested frame is always finished, Present waits for it
+			RenderSnapshot* snapshot = m_pBuildSnapshot;
+			if(snapshot == nullptr)
+			{
+				return;
+			}
+
+			lock.unlock();
+			BuildFrame(*snapshot);
+			lock.lock();
+
+			m_pBuildSnapshot = nullptr;
+			m_RenderCondition.notify_all();
+		}
+	}
+
+	void SpriteBatch::WaitForRenderThread()
+	{
+		std::unique_lock<std::mutex> lock(m_RenderMutex);
+		m_RenderCondition.wait(lock, [this]()
+		{
+			return m_pBuildSnapshot == nullptr;
+		});
+	}
 	
-	void SpriteBatch::Begin()
+	void SpriteBatch::Begin(const RenderSnapshot& snapshot)
 	{
+		m_bInstancedProgramBound = false;
 		m_ShaderPtr->Bind();
-		
-		//[TODO] Test android!
-		glEnableVertexAttribArray(m_VertexID);
-		glEnableVertexAttribArray(m_UVID);
-		glEnableVertexAttribArray(m_IsHUDID);
-		glEnableVertexAttribArray(m_ColorID);
-
-		//Create Vertexbuffer
-		SortSprites(m_SpriteSortingMode);
-		CreateSpriteQuads();
-		
-		//Set uniforms
-		glUniform1i(m_TextureSamplerID, 0);
-		float scaleValue = ScaleSystem::GetInstance()->GetScale();
-		mat4 scaleMat = Scale(scaleValue, scaleValue, 0);
-		glUniformMatrix4fv(m_ScalingID, 1, GL_FALSE, ToPointerValue(scaleMat));
+		GLStateCache::GetInstance()->SetEnabledVertexAttribArrays(m_VertexAttribMask);
 
-		const mat4& viewInverseMat = GraphicsManager::GetInstance()->GetViewInverseMatrix();
-		glUniformMatrix4fv(m_ViewInverseID, 1, GL_FALSE, ToPointerValue(viewInverseMat));
+		UploadStaticVertexData();
+		if(m_bInstancedFrame)
+		{
+			UploadInstanceData();
+		}
+		UploadVertexData();
+		
+		//Set uniforms, the instanced program gets the same ones
+		SetUniforms(snapshot, m_TextureSamplerID, m_ScalingID,
+			m_ViewInverseID, m_ProjectionID);
+		if(m_bInstancedFrame)
+		{
+			m_InstancedShaderPtr->Bind();
+			SetUniforms(snapshot, m_InstanceTextureSamplerID, m_InstanceScalingID,
+				m_InstanceViewInverseID, m_InstanceProjectionID);
+			m_ShaderPtr->Bind();
+		}
+	}
 
-		const mat4& projectionMat = GraphicsManager::GetInstance()->GetProjectionMatrix();
-		glUniformMatrix4fv(m_ProjectionID, 1, GL_FALSE, ToPointerValue(projectionMat));
+	void SpriteBatch::SetUniforms(const RenderSnapshot& snapshot, GLuint samplerID,
+			GLuint scalingID, GLuint viewInverseID, GLuint projectionID) const
+	{
+		//The matrices of the frame the snapshot was taken in
+		glUniform1i(samplerID, 0);
+		glUniformMatrix4fv(scalingID, 1, GL_FALSE,
+			ToPointerValue(snapshot.scaleMatrix));
+		glUniformMatrix4fv(viewInverseID, 1, GL_FALSE,
+			ToPointerValue(snapshot.viewInverseMatrix));
+		glUniformMatrix4fv(projectionID, 1, GL_FALSE,
+			ToPointerValue(snapshot.projectionMatrix));
 	}
 	
-	void SpriteBatch::DrawSprites()
-	{			
+	void SpriteBatch::DrawSprites(const std::vector<SpriteRecord>& queue)
+	{
+		//The retained quad batches are drawn in between the dynamic sprites,
+		//right before the first dynamic sprite on a later layer.
+		uint32 quadBatch(0);
 		uint32 batchStart(0);
 		uint32 batchSize(0);
 		GLuint texture(0);
-		for(const SpriteInfo* currentSprite : m_SpriteQueue)
-		{	
+		for(uint32 i = 0; i < queue.size(); ++i)
+		{
+			const SpriteRecord& currentSprite = queue[i];
+			uint32 layerKey = uint32(m_SortEntries[i].key >> SORT_LAYER_SHIFT);
+			if(quadBatch < m_QuadBatchQueue.size()
+				&& m_QuadBatchQueue[quadBatch].layerKey <= layerKey)
+			{
+				FlushSpriteRange(batchStart, batchSize, texture);
+
+				batchStart += batchSize;
+				batchSize = 0;
+
+				texture = 0;
+				quadBatch = DrawQuadBatches(quadBatch, layerKey);
+			}
+
 			//If != -> Flush
-			if(texture != currentSprite->textureID)
+			if(texture != currentSprite.textureID)
 			{
-				FlushSprites(batchStart, batchSize, texture);
+				FlushSpriteRange(batchStart, batchSize, texture);
 
 				batchStart += batchSize;
 				batchSize = 0;
 
-				texture = currentSprite->textureID;
+				texture = currentSprite.textureID;
 			}
 			++batchSize;
 		}	
-		FlushSprites(batchStart, batchSize, texture);
+		FlushSpriteRange(batchStart, batchSize, texture);
+		DrawQuadBatches(quadBatch, ~uint32(0));
 	}
 
-	void SpriteBatch::FlushSprites(uint32 start, uint32 size, uint32 texture)
+	bool SpriteBatch::IsStaticCacheValid(const std::vector<SpriteRecord>& queue) const
 	{
-		if(size > 0)
-		{	
-			//[TODO] Check if this can be optimized
-			glBindTexture(GL_TEXTURE_2D, texture);
-		
-			//Set attributes and buffers
-			glVertexAttribPointer(m_VertexID, 4, GL_FLOAT, 0, 0, 
-				reinterpret_cast<GLvoid*>(&m_VertexBuffer.at(0)));
-			glVertexAttribPointer(m_UVID, 2, GL_FLOAT, 0, 0, 
-				reinterpret_cast<GLvoid*>(&m_UvCoordBuffer.at(0)));
-			glVertexAttribPointer(m_IsHUDID, 1, GL_FLOAT, 0, 0,
-				reinterpret_cast<GLvoid*>(&m_IsHUDBuffer.at(0)));
-			glVertexAttribPointer(m_ColorID, 4, GL_FLOAT, 0, 0,
-				reinterpret_cast<GLvoid*>(&m_ColorBuffer.at(0)));
+		if(queue.size() != m_StaticSpriteStates.size()
+			|| m_StaticSortingMode != m_FrameSortingMode
+			|| m_bStaticInVertexBuffer != m_bStreamingFrame)
+		{
+			return false;
+		}
 
-			glDrawArrays(GL_TRIANGLES, start * 6, size * 6);	
+		for(uint32 i = 0; i < queue.size(); ++i)
+		{
+			const SpriteRecord& sprite = queue[i];
+			const StaticSpriteState& state = m_StaticSpriteStates[i];
+			if(sprite.source != state.sprite
+				|| sprite.version != state.version
+				|| sprite.transformVersion != state.transformVersion)
+			{
+				return false;
+			}
 		}
+		return true;
 	}
-	
-	void SpriteBatch::End()
+
+	void SpriteBatch::RebuildStaticSprites(std::vector<SpriteRecord>& queue)
 	{
-		//Unbind attributes and buffers
-		glDisableVertexAttribArray(m_VertexID);
-		glDisableVertexAttribArray(m_UVID);
-		glDisableVertexAttribArray(m_IsHUDID);
-		glDisableVertexAttribArray(m_ColorID);
+		m_StaticSpriteStates.clear();
+		for(const SpriteRecord& sprite : queue)
+		{
+			StaticSpriteState state;
+			state.sprite = sprite.source;
+			state.version = sprite.version;
+			state.transformVersion = sprite.transformVersion;
+			m_StaticSpriteStates.push_back(state);
+		}
+		m_StaticSortingMode = m_FrameSortingMode;
+		m_bStaticInVertexBuffer = m_bStreamingFrame;
 
-		m_ShaderPtr->Unbind();
+		SortSprites(queue, m_FrameSortingMode);
 
-		m_SpriteQueue.clear();
-		m_TextQueue.clear();
+		m_StaticBatches.clear();
+		for(uint32 i = 0; i < queue.size(); ++i)
+		{
+			uint32 layerKey = uint32(m_SortEntries[i].key >> SORT_LAYER_SHIFT);
+			uint32 texture = queue[i].textureID;
+			if(m_StaticBatches.empty()
+				|| m_StaticBatches.back().layerKey != layerKey
+				|| m_StaticBatches.back().texture != texture)
+			{
+				QuadBatch batch;
+				batch.layerKey = layerKey;
+				batch.texture = texture;
+				batch.vertexBufferID = 0;
+				batch.vertices = nullptr;
+				batch.start = i;
+				batch.size = 0;
+				m_StaticBatches.push_back(batch);
+			}
+			++m_StaticBatches.back().size;
+		}
 
+		//The dynamic vertexbuffer is still empty at this point,
+		//generate the static quads in it and take them over.
+		CreateSpriteQuads(queue);
+		m_StaticVertexBuffer.swap(m_VertexBuffer);
 		m_VertexBuffer.clear();
-		m_UvCoordBuffer.clear();
-		m_IsHUDBuffer.clear();
-		m_ColorBuffer.clear();
-	}
 
-	void SpriteBatch::DrawTextSprites()
-	{	
-		CreateTextQuads();
+		//Uploaded when the frame gets drawn, on the thread owning the context
+		m_bStaticUploadPending = m_bStreamingFrame && !m_StaticVertexBuffer.empty();
+		if(m_StaticVertexBuffer.empty())
+		{
+			return;
+		}
 
-		//FlushText once per TextComponent (same font)
-		//Check per text how many characters -> Forloop drawing
-		int32 startIndex(0);
-		for(const TextInfo* text : m_TextQueue)
+		GLuint vertexBufferID = m_bStreamingFrame ? m_StaticVertexBufferID : 0;
+		for(QuadBatch & batch : m_StaticBatches)
 		{
-			GLuint* textures = text->font->GetTextures();
+			batch.vertexBufferID = vertexBufferID;
+			batch.vertices = &m_StaticVertexBuffer.at(0);
+		}
+	}
 
-			const tchar *start_line = text->text.c_str();
-			for(int32 i = 0 ; start_line[i] != 0 ; ++i) 
+	void SpriteBatch::UploadStaticVertexData()
+	{
+		if(!m_bStaticUploadPending)
+		{
+			return;
+		}
+		m_bStaticUploadPending = false;
+
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, m_StaticVertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, m_StaticVertexBuffer.size() * sizeof(SpriteVertex),
+			&m_StaticVertexBuffer.at(0), GL_STATIC_DRAW);
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, 0);
+		OPENGL_LOG();
+
+		RenderStats& stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		++stats.bufferUploads;
+		stats.bytesUploaded += m_StaticVertexBuffer.size() * sizeof(SpriteVertex);
+	}
+
+	void SpriteBatch::QueueQuadBatches(const std::vector<QuadBatchInfo>& infos)
+	{
+		//Merge the static batches with the quad batches that were queued
+		//this frame. The sort is stable, so on the same layer the static
+		//sprites come first and the quad batches keep their queue order.
+		m_QuadBatchQueue.assign(m_StaticBatches.begin(), m_StaticBatches.end());
+		for(const QuadBatchInfo& info : infos)
+		{
+			if(info.size == 0)
 			{
-				if(start_line[i] > FIRST_REAL_ASCII_CHAR)
-				{
-					glBindTexture(GL_TEXTURE_2D, textures[start_line[i]]);
-
-					//Set attributes and buffers
-					glVertexAttribPointer(m_VertexID, 4, GL_FLOAT, 0, 0,
-						reinterpret_cast<GLvoid*>(&m_VertexBuffer.at(0)));
-					glVertexAttribPointer(m_UVID, 2, GL_FLOAT, 0, 0, 
-						reinterpret_cast<GLvoid*>(&m_UvCoordBuffer.at(0)));
-					glVertexAttribPointer(m_IsHUDID, 1, GL_FLOAT, 0, 0,
-						reinterpret_cast<GLvoid*>(&m_IsHUDBuffer.at(0)));
-					glVertexAttribPointer(m_ColorID, 4, GL_FLOAT, 0, 0,
-						reinterpret_cast<GLvoid*>(&m_ColorBuffer.at(0)));
-					glDrawArrays(GL_TRIANGLES, startIndex * 6, 6);
-				}
-				++startIndex;
+				continue;
 			}
+
+			QuadBatch batch;
+			batch.layerKey = CreateLayerKey(info.bIsHud, info.layer, m_FrameSortingMode);
+			batch.texture = info.textureID;
+			batch.vertexBufferID = m_bStreamingFrame ? info.vertexBufferID : 0;
+			batch.vertices = info.vertices;
+			batch.start = info.start;
+			batch.size = info.size;
+			m_QuadBatchQueue.push_back(batch);
 		}
+
+		std::stable_sort(m_QuadBatchQueue.begin(), m_QuadBatchQueue.end(),
+			[](const QuadBatch & a, const QuadBatch & b) -> bool
+		{
+			return a.layerKey < b.layerKey;
+		});
 	}
 
-	void SpriteBatch::CreateSpriteQuads()
-	{	
-		//for every sprite that has to be drawn, push back all vertices 
-		//(VERTEX_AMOUNT per sprite) into the vertexbuffer and all uvcoords 
-		//(UV_AMOUNT per sprite) into the uvbuffer and the isHUD bool
-		/*
-		*  TL    TR
-		*   0----1 
-		*   |   /| 
-		*   |  / |
-		*   | /  |
-		*   |/   |
-		*   2----3
-		*  BL    BR
-		*/
+	uint32 SpriteBatch::DrawQuadBatches(uint32 firstBatch, uint32 maxLayerKey)
+	{
+		//Draws all quad batches up to and including maxLayerKey
+		//and returns the index of the first batch that wasn't drawn.
+		uint32 lastBatch(firstBatch);
+		if(lastBatch < m_QuadBatchQueue.size()
+			&& m_QuadBatchQueue[lastBatch].layerKey <= maxLayerKey)
+		{
+			UseInstancedProgram(false);
+		}
+		for( ; lastBatch < m_QuadBatchQueue.size()
+			&& m_QuadBatchQueue[lastBatch].layerKey <= maxLayerKey; ++lastBatch)
+		{
+			const QuadBatch& batch = m_QuadBatchQueue[lastBatch];
+			if(batch.vertexBufferID != m_SourceVertexBufferID
+				|| batch.vertices != m_SourceVertices)
+			{
+				SetVertexSource(batch.vertexBufferID, batch.vertices);
+			}
+			FlushSprites(batch.start, batch.size, batch.texture);
+		}
+		GraphicsManager::GetInstance()->GetCurrentRenderStats().quadBatches +=
+			lastBatch - firstBatch;
 
-		for(const SpriteInfo* sprite : m_SpriteQueue)
+		if(lastBatch != firstBatch && !m_VertexBuffer.empty())
 		{
-			//Push back all vertices
-			
-			mat4 transformMat = Transpose(sprite->transformPtr->GetWorldMatrix());
+			SetDynamicVertexSource();
+		}
+		return lastBatch;
+	}
 
-			vec4 TL = vec4(0, sprite->vertices.y, 0, 1);
-			Mul(TL, transformMat, TL);
+	void SpriteBatch::FlushSpriteRange(uint32 start, uint32 size, uint32 texture)
+	{
+		if(m_bInstancedFrame)
+		{
+			FlushSpriteInstances(start, size, texture);
+		}
+		else
+		{
+			FlushSprites(start, size, texture);
+		}
+	}
 
-			vec4 TR = vec4(sprite->vertices.x, sprite->vertices.y, 0, 1);
-			Mul(TR, transformMat, TR);
+	void SpriteBatch::FlushSpriteInstances(uint32 start, uint32 size, uint32 texture)
+	{
+		if(size == 0)
+		{
+			return;
+		}
+		UseInstancedProgram(true);
+
+		//There is no base instance in GL 3.3 / GLES 3,
+		//so the instance attributes are moved to the first sprite instead.
+		const GLsizei stride = sizeof(SpriteInstance);
+		const uint8* instancePtr = nullptr;
+		instancePtr += start * stride;
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER,
+			m_InstanceBufferIDs[m_CurrentInstanceBuffer]);
+		glVertexAttribPointer(m_InstanceAxesID, 4, GL_FLOAT, GL_FALSE, stride,
+			instancePtr + offsetof(SpriteInstance, axes));
+		glVertexAttribPointer(m_InstanceOriginID, 3, GL_FLOAT, GL_FALSE, stride,
+			instancePtr + offsetof(SpriteInstance, x));
+		glVertexAttribPointer(m_InstanceUVID, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+			instancePtr + offsetof(SpriteInstance, uvRect));
+		glVertexAttribPointer(m_InstanceColorID, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+			instancePtr + offsetof(SpriteInstance, r));
+		glVertexAttribPointer(m_InstanceIsHUDID, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride,
+			instancePtr + offsetof(SpriteInstance, flags));
+
+		GLStateCache::GetInstance()->BindTexture(texture);
+		GraphicsManager::GetInstance()->DrawArraysInstanced(
+			GL_TRIANGLE_STRIP, 0, VERTICES_PER_QUAD, size);
+		++GraphicsManager::GetInstance()->GetCurrentRenderStats().drawCalls;
+	}
 
-			vec4 BL = vec4(0, 0, 0, 1);
-			Mul(BL, transformMat, BL);
+	void SpriteBatch::UseInstancedProgram(bool instanced)
+	{
+		//Attribute arrays and divisors are global state,
+		//so they are swapped along with the program.
+		if(instanced == m_bInstancedProgramBound)
+		{
+			return;
+		}
+		m_bInstancedProgramBound = instanced;
 
-			vec4 BR = vec4(sprite->vertices.x, 0, 0, 1);
-			Mul(BR, transformMat, BR);
+		//The corner attribute is per vertex, the rest per instance
+		const GLuint instanceAttributes[] = 
+		{
+			m_InstanceAxesID,
+			m_InstanceOriginID,
+			m_InstanceUVID,
+			m_InstanceColorID,
+			m_InstanceIsHUDID
+		};
+
+		if(instanced)
+		{
+			m_InstancedShaderPtr->Bind();
+			GLStateCache::GetInstance()->SetEnabledVertexAttribArrays(m_InstanceAttribMask);
 
-			//0
-			m_VertexBuffer.push_back(TL);
+			GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, m_CornerBufferID);
+			glVertexAttribPointer(m_InstanceCornerID, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+			for(GLuint attribute : instanceAttributes)
+			{
+				GraphicsManager::GetInstance()->VertexAttribDivisor(attribute, 1);
+			}
+		}
+		else
+		{
+			for(GLuint attribute : instanceAttributes)
+			{
+				GraphicsManager::GetInstance()->VertexAttribDivisor(attribute, 0);
+			}
 
-			//1
-			m_VertexBuffer.push_back(TR);
+			m_ShaderPtr->Bind();
+			GLStateCache::GetInstance()->SetEnabledVertexAttribArrays(m_VertexAttribMask);
+			SetVertexSource(m_SourceVertexBufferID, m_SourceVertices);
+		}
+	}
 
-			//2
-			m_VertexBuffer.push_back(BL);
+	void SpriteBatch::FlushSprites(uint32 start, uint32 size, uint32 texture)
+	{
+		if(size > 0)
+		{	
+			//Consecutive batches often share a texture,
+			//the state cache filters out those rebinds.
+			GLStateCache::GetInstance()->BindTexture(texture);
+			DrawQuads(start, size);
+		}
+	}
 
-			//1
-			m_VertexBuffer.push_back(TR);
+	void SpriteBatch::DrawQuads(uint32 start, uint32 size)
+	{
+		//The shared index buffer only addresses MAX_QUADS_PER_DRAW quads,
+		//so the vertex data is split in pages of that size and the 
+		//attribute pointers are moved when a range crosses into a new page.
+		RenderStats& stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		while(size > 0)
+		{
+			uint32 page = start / MAX_QUADS_PER_DRAW;
+			if(page != m_CurrentQuadPage)
+			{
+				SetVertexAttribPointers(page * MAX_QUADS_PER_DRAW * VERTICES_PER_QUAD);
+				m_CurrentQuadPage = page;
+			}
 
-			//3
-			m_VertexBuffer.push_back(BR);
+			uint32 pageStart = start - page * MAX_QUADS_PER_DRAW;
+			uint32 amount = std::min(size, MAX_QUADS_PER_DRAW - pageStart);
 
-			//2
-			m_VertexBuffer.push_back(BL);
+			const uint8* indices = m_bStreamingFrame ? nullptr 
+				: reinterpret_cast<const uint8*>(&m_IndexBuffer.at(0));
+			glDrawElements(GL_TRIANGLES, amount * INDICES_PER_QUAD, GL_UNSIGNED_SHORT,
+				indices + pageStart * INDICES_PER_QUAD * sizeof(uint16));
+			++stats.drawCalls;
 
-			//Push back all uv's
+			start += amount;
+			size -= amount;
+		}
+	}
+	
+	void SpriteBatch::CreateSpriteInstances(const std::vector<SpriteRecord>& queue)
+	{
+		m_InstanceBuffer.resize(queue.size());
+		for(uint32 i = 0; i < queue.size(); ++i)
+		{
+			const SpriteRecord& sprite = queue[i];
+			const mat4& worldMat = sprite.worldMatrix;
+
+			QuadTransformInput input;
+			SetQuadTransform(worldMat, sprite.vertices.x, sprite.vertices.y, input);
+
+			SpriteInstance& instance = m_InstanceBuffer[i];
+			instance.axes[0] = input.a * input.width;
+			instance.axes[1] = input.b * input.width;
+			instance.axes[2] = input.c * input.height;
+			instance.axes[3] = input.d * input.height;
+			instance.x = input.tx;
+			instance.y = input.ty;
+			instance.layer = worldMat[3][2];
+
+			instance.uvRect[0] = PackUV(sprite.uvCoords.x);
+			instance.uvRect[1] = PackUV(sprite.uvCoords.y);
+			instance.uvRect[2] = PackUV(sprite.uvCoords.x + sprite.uvCoords.z);
+			instance.uvRect[3] = PackUV(sprite.uvCoords.y + sprite.uvCoords.w);
+
+			instance.r = PackColorChannel(sprite.colorMultiplier.r);
+			instance.g = PackColorChannel(sprite.colorMultiplier.g);
+			instance.b = PackColorChannel(sprite.colorMultiplier.b);
+			instance.a = PackColorChannel(sprite.colorMultiplier.a);
+			instance.flags = sprite.bIsHud ? SpriteVertex::HUD_FLAG : 0;
+			instance.padding[0] = instance.padding[1] = instance.padding[2] = 0;
+		}
+	}
 
-			//0
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y + sprite->uvCoords.w);
+	void SpriteBatch::UploadInstanceData()
+	{
+		if(m_InstanceBuffer.empty())
+		{
+			return;
+		}
 
-			//1
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x + sprite->uvCoords.z);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y + sprite->uvCoords.w);
+		//Same ring of orphaned buffers as the vertex data
+		m_CurrentInstanceBuffer = (m_CurrentInstanceBuffer + 1) % VERTEX_BUFFER_COUNT;
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER,
+			m_InstanceBufferIDs[m_CurrentInstanceBuffer]);
 
-			//2
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y);
+		const uint32 totalSize = m_InstanceBuffer.size() * sizeof(SpriteInstance);
+		uint32& bufferSize = m_InstanceBufferSizes[m_CurrentInstanceBuffer];
+		if(totalSize > bufferSize)
+		{
+			bufferSize = totalSize + totalSize / 2;
+		}
+		glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, totalSize, &m_InstanceBuffer.at(0));
+		OPENGL_LOG();
 
-			//1
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x + sprite->uvCoords.z);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y + sprite->uvCoords.w);
+		RenderStats& stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		++stats.bufferUploads;
+		stats.bytesUploaded += totalSize;
+	}
 
-			//3
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x + sprite->uvCoords.z);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y);
+	void SpriteBatch::UploadVertexData()
+	{
+		if(m_VertexBuffer.empty())
+		{
+			return;
+		}
 
-			//2
-			m_UvCoordBuffer.push_back(sprite->uvCoords.x);
-			m_UvCoordBuffer.push_back(sprite->uvCoords.y);
+		const uint8* vertexPtr = reinterpret_cast<const uint8*>(&m_VertexBuffer.at(0));
 
-			//bool & color buffer
-			for(uint32 i = 0; i < 6; ++i)
+		if(m_bStreamingFrame)
+		{
+			//Use the next buffer in the ring, so we don't write to
+			//a buffer the GPU might still be reading from last frame.
+			m_CurrentVertexBuffer = (m_CurrentVertexBuffer + 1) % VERTEX_BUFFER_COUNT;
+			GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER,
+				m_VertexBufferIDs[m_CurrentVertexBuffer]);
+
+			const uint32 totalSize = m_VertexBuffer.size() * sizeof(SpriteVertex);
+			uint32& bufferSize = m_VertexBufferSizes[m_CurrentVertexBuffer];
+			if(totalSize > bufferSize)
 			{
-				m_IsHUDBuffer.push_back(float32(sprite->bIsHud));
-				//rgba
-				m_ColorBuffer.push_back(sprite->colorMultiplier);
+				//Grow with some slack to avoid reallocating every frame
+				bufferSize = totalSize + totalSize / 2;
 			}
+			//Orphan the old storage, the driver can hand us a fresh block
+			glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, totalSize, vertexPtr);
+			OPENGL_LOG();
+
+			RenderStats& stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+			++stats.bufferUploads;
+			stats.bytesUploaded += totalSize;
+		}
+
+		//Set attributes once, every batch draws a range out of them
+		SetDynamicVertexSource();
+	}
+
+	void SpriteBatch::SetVertexSource(GLuint vertexBufferID, const SpriteVertex* vertices)
+	{
+		//Switches between the streamed vertices of this frame
+		//and retained vertices. Without a vertex buffer ID, 
+		//the vertices are read from client memory.
+		m_SourceVertexBufferID = vertexBufferID;
+		m_SourceVertices = vertices;
+		//Client memory pointers need both bindings to be 0
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+		GLStateCache::GetInstance()->BindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+			m_bStreamingFrame ? m_IndexBufferID : 0);
+		SetVertexAttribPointers(0);
+		m_CurrentQuadPage = 0;
+	}
+
+	void SpriteBatch::SetDynamicVertexSource()
+	{
+		SetVertexSource(
+			m_bStreamingFrame ? m_VertexBufferIDs[m_CurrentVertexBuffer] : 0,
+			&m_VertexBuffer.at(0)
+			);
+	}
+
+	void SpriteBatch::SetVertexAttribPointers(uint32 firstVertex)
+	{
+		const GLsizei stride = sizeof(SpriteVertex);
+		const uint8* vertexPtr = m_SourceVertexBufferID != 0 ? nullptr
+			: reinterpret_cast<const uint8*>(m_SourceVertices);
+		vertexPtr += firstVertex * stride;
+
+		glVertexAttribPointer(m_VertexID, 3, GL_FLOAT, GL_FALSE, stride,
+			vertexPtr + offsetof(SpriteVertex, x));
+		glVertexAttribPointer(m_UVID, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+			vertexPtr + offsetof(SpriteVertex, u));
+		glVertexAttribPointer(m_ColorID, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+			vertexPtr + offsetof(SpriteVertex, r));
+		glVertexAttribPointer(m_IsHUDID, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride,
+			vertexPtr + offsetof(SpriteVertex, flags));
+	}
+
+	void SpriteBatch::SetVertexInfo(SpriteVertex& vertex, const Color& color, bool isHUD) const
+	{
+		vertex.r = PackColorChannel(color.r);
+		vertex.g = PackColorChannel(color.g);
+		vertex.b = PackColorChannel(color.b);
+		vertex.a = PackColorChannel(color.a);
+		vertex.flags = isHUD ? SpriteVertex::HUD_FLAG : 0;
+		vertex.padding[0] = vertex.padding[1] = vertex.padding[2] = 0;
+	}
+
+	void SpriteBatch::PushVertex(SpriteVertex& vertex, uint16 u, uint16 v)
+	{
+		vertex.u = u;
+		vertex.v = v;
+		m_VertexBuffer.push_back(vertex);
+	}
+
+	void SpriteBatch::TransformQuads(uint32 firstVertex)
+	{
+		//Transforms the corners of all queued quads at once
+		//and writes them in the vertices that were pushed for them.
+		uint32 amount = m_QuadInputs.size();
+		if(amount == 0)
+		{
+			return;
+		}
+		m_QuadCorners.resize(amount);
+		TransformQuadCorners(&m_QuadInputs[0], amount, &m_QuadCorners[0]);
+
+		SpriteVertex* vertex = &m_VertexBuffer[firstVertex];
+		for(const QuadCorners & corners : m_QuadCorners)
+		{
+			vertex[0].x = corners.TL.x;
+			vertex[0].y = corners.TL.y;
+			vertex[1].x = corners.TR.x;
+			vertex[1].y = corners.TR.y;
+			vertex[2].x = corners.BL.x;
+			vertex[2].y = corners.BL.y;
+			vertex[3].x = corners.BR.x;
+			vertex[3].y = corners.BR.y;
+			vertex += VERTICES_PER_QUAD;
 		}
+		m_QuadInputs.clear();
+	}
+
+	uint16 SpriteBatch::PackUV(float32 uv)
+	{
+		return uint16(Clamp(uv, 0.0f, 1.0f) * 65535.0f + 0.5f);
 	}
 
-	void SpriteBatch::CreateTextQuads()
+	uint8 SpriteBatch::PackColorChannel(float32 channel)
 	{
-		//for every sprite that has to be drawn, push back all vertices 
-		//(VERTEX_AMOUNT per sprite) into the vertexbuffer and all uvcoords 
-		//(UV_AMOUNT per sprite) into the uvbuffer and the isHUD bool
+		return uint8(Clamp(channel, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	void SpriteBatch::End()
+	{
+		//The program, attributes and buffers stay bound,
+		//so the next flush doesn't have to set them again.
+		m_QuadBatchQueue.clear();
+		m_SourceVertexBufferID = 0;
+		m_SourceVertices = nullptr;
+
+		m_VertexBuffer.clear();
+		m_InstanceBuffer.clear();
+	}
+
+	void SpriteBatch::DrawTextSprites(const std::vector<TextRecord>& texts)
+	{	
+		//All glyphs of a font live in one atlas texture,
+		//so consecutive texts with the same font are drawn in one batch.
+		//The text quads are stored right behind the sprite quads.
+		UseInstancedProgram(false);
+		uint32 batchStart(m_FirstTextQuad);
+		uint32 batchSize(0);
+		GLuint texture(0);
+		for(const TextRecord& text : texts)
+		{
+			if(texture != text.textureID)
+			{
+				FlushSprites(batchStart, batchSize, texture);
+
+				batchStart += batchSize;
+				batchSize = 0;
+
+				texture = text.textureID;
+			}
+			batchSize += text.glyphCount;
+		}
+		FlushSprites(batchStart, batchSize, texture);
+	}
+
+	void SpriteBatch::CreateSpriteQuads(const std::vector<SpriteRecord>& queue)
+	{	
+		//for every sprite that has to be drawn, push back 4 packed vertices
+		//(position, uv, color and the isHUD flag) into the vertexbuffer.
+		//The triangles are formed by the shared index buffer.
 		/*
 		*  TL    TR
 		*   0----1 
@@ -297,136 +1107,215 @@ namespace star
 		*   2----3
 		*  BL    BR
 		*/
-		for(const TextInfo* text : m_TextQueue)
-		{
-			//Variables per textcomponent
-			mat4 transformMat, offsetMatrix; 
-			const mat4& worldMat = text->transformPtr->GetWorldMatrix();
-			int32 line_counter(0);
-			int32 offsetX(text->horizontalTextOffset.at(line_counter));
-			int32 offsetY(0);
-			int32 fontHeight(text->font->GetMaxLetterHeight() + text->font->GetMinLetterHeight());
-			for(auto it : text->text)
-			{
-				const CharacterInfo& charInfo = text->font->GetCharacterInfo(static_cast<suchar>(it));
-				offsetMatrix = Translate
-					(vec3(
-						offsetX, 
-						offsetY + charInfo.letterDimensions.y + text->textHeight - fontHeight, 
-						0));
-				offsetX += charInfo.letterDimensions.x;
 
-				transformMat = Transpose(worldMat * offsetMatrix);
+		//The positions are filled in afterwards by TransformQuads,
+		//which handles the corners of all sprites in one go.
+		uint32 firstVertex = m_VertexBuffer.size();
+		m_QuadInputs.reserve(queue.size());
+		m_VertexBuffer.reserve(firstVertex + queue.size() * VERTICES_PER_QUAD);
+		for(const SpriteRecord& sprite : queue)
+		{
+			const mat4& worldMat = sprite.worldMatrix;
 
-				vec4 TL = vec4(0, charInfo.vertexDimensions.y, 0, 1);
-				Mul(TL, transformMat, TL);
+			QuadTransformInput input;
+			SetQuadTransform(worldMat, sprite.vertices.x, sprite.vertices.y, input);
+			m_QuadInputs.push_back(input);
 
-				vec4 TR = vec4(charInfo.vertexDimensions.x, charInfo.vertexDimensions.y, 0, 1);
-				Mul(TR, transformMat, TR);
+			SpriteVertex vertex;
+			SetVertexInfo(vertex, sprite.colorMultiplier, sprite.bIsHud);
+			vertex.layer = worldMat[3][2];
 
-				vec4 BL = vec4(0, 0, 0, 1);
-				Mul(BL, transformMat, BL);
+			uint16 uLeft = PackUV(sprite.uvCoords.x),
+				   uRight = PackUV(sprite.uvCoords.x + sprite.uvCoords.z),
+				   vBottom = PackUV(sprite.uvCoords.y),
+				   vTop = PackUV(sprite.uvCoords.y + sprite.uvCoords.w);
 
-				vec4 BR = vec4(charInfo.vertexDimensions.x, 0, 0, 1);
-				Mul(BR, transformMat, BR);
+			//0
+			PushVertex(vertex, uLeft, vTop);
+			//1
+			PushVertex(vertex, uRight, vTop);
+			//2
+			PushVertex(vertex, uLeft, vBottom);
+			//3
+			PushVertex(vertex, uRight, vBottom);
+		}
+		TransformQuads(firstVertex);
+	}
 
-				//0
-				m_VertexBuffer.push_back(TL);
+	void SpriteBatch::CreateTextQuads(const RenderSnapshot& snapshot)
+	{
+		//for every glyph that has to be drawn, push back 4 packed vertices
+		//(position, uv, color and the isHUD flag) into the vertexbuffer.
+		//The triangles are formed by the shared index buffer.
+		/*
+		*  TL    TR
+		*   0----1 
+		*   |   /| 
+		*   |  / |
+		*   | /  |
+		*   |/   |
+		*   2----3
+		*  BL    BR
+		*/
 
-				//1
-				m_VertexBuffer.push_back(TR);
+		//The TextComponent keeps its glyph quads in world space,
+		//they only have to be copied in the vertexbuffer.
+		for(const TextRecord& text : snapshot.texts)
+		{
+			SpriteVertex vertex;
+			SetVertexInfo(vertex, text.colorMultiplier, text.bIsHud);
+			vertex.layer = text.depth;
 
-				//2
-				m_VertexBuffer.push_back(BL);
+			m_VertexBuffer.reserve(m_VertexBuffer.size() + text.glyphCount * VERTICES_PER_QUAD);
+			for(uint32 i = text.firstGlyph; i < text.firstGlyph + text.glyphCount; ++i)
+			{
+				const GlyphQuad& glyph = snapshot.glyphs[i];
+				const QuadCorners& corners = snapshot.glyphCorners[i];
 
+				//0
+				vertex.x = corners.TL.x;
+				vertex.y = corners.TL.y;
+				PushVertex(vertex, glyph.uLeft, glyph.vTop);
 				//1
-				m_VertexBuffer.push_back(TR);
-
-				//3
-				m_VertexBuffer.push_back(BR);
-
+				vertex.x = corners.TR.x;
+				vertex.y = corners.TR.y;
+				PushVertex(vertex, glyph.uRight, glyph.vTop);
 				//2
-				m_VertexBuffer.push_back(BL);
-
-				//Push back all uv's
-
-				//0
-				m_UvCoordBuffer.push_back(0);
-				m_UvCoordBuffer.push_back(0);
+				vertex.x = corners.BL.x;
+				vertex.y = corners.BL.y;
+				PushVertex(vertex, glyph.uLeft, glyph.vBottom);
+				//3
+				vertex.x = corners.BR.x;
+				vertex.y = corners.BR.y;
+				PushVertex(vertex, glyph.uRight, glyph.vBottom);
+			}
+		}
+	}
 
-				//1
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.x);
-				m_UvCoordBuffer.push_back(0);
+	void SpriteBatch::SortSprites(std::vector<SpriteRecord>& queue, SpriteSortingMode mode)
+	{
+		//Compute one key per sprite up front, so the sort itself
+		//never has to touch the transforms.
+		//Afterwards m_SortEntries holds the keys in the sorted order.
+		uint32 amount = queue.size();
+		m_SortEntries.resize(amount);
+		for(uint32 i = 0; i < amount; ++i)
+		{
+			m_SortEntries[i].key = CreateSortKey(queue[i], mode);
+			m_SortEntries[i].index = i;
+		}
 
-				//2
-				m_UvCoordBuffer.push_back(0);
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.y);
+		if(amount < 2)
+		{
+			return;
+		}
 
-				//1
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.x);
-				m_UvCoordBuffer.push_back(0);
+		RadixSortKeys();
 
-				//3
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.x);
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.y);
+		m_SortedSpriteQueue.resize(amount);
+		for(uint32 i = 0; i < amount; ++i)
+		{
+			m_SortedSpriteQueue[i] = queue[m_SortEntries[i].index];
+		}
+		queue.swap(m_SortedSpriteQueue);
+	}
 
-				//2
-				m_UvCoordBuffer.push_back(0);
-				m_UvCoordBuffer.push_back(charInfo.uvDimensions.y);
-
-				//bool & color buffer
-				for(uint32 i = 0; i < 6; ++i)
-				{
-					m_IsHUDBuffer.push_back(float32(text->bIsHud));
-					//rgba
-					m_ColorBuffer.push_back(text->colorMultiplier);
-				}
-
-				if(it == _T('\n'))
-				{
-					offsetY -= text->font->GetMaxLetterHeight() + text->verticalSpacing;
-					++line_counter;
-					offsetX = text->horizontalTextOffset.at(line_counter);
-				}
-			}
+	uint64 SpriteBatch::CreateSortKey(const SpriteRecord& sprite, SpriteSortingMode mode) const
+	{
+		uint64 layerKey = CreateLayerKey(sprite.bIsHud, sprite.layer, mode);
+		uint64 texture(0);
+		if(mode == SpriteSortingMode::TextureID)
+		{
+			texture = sprite.textureID;
 		}
+
+		//The material bits are reserved for when sprites get custom shaders
+		return (layerKey << SORT_LAYER_SHIFT)
+			| (texture << SORT_TEXTURE_SHIFT);
 	}
 
-	void SpriteBatch::SortSprites(SpriteSortingMode mode)
+	uint32 SpriteBatch::CreateLayerKey(bool isHud, lay layer, SpriteSortingMode mode)
 	{
+		//HUD sprites always end up on top of the world.
+		//The layer is biased so negative layers sort below positive ones.
+		uint32 hud = isHud ? 1 : 0;
+		uint32 biasedLayer = uint32(int32(layer) + 128);
+
 		switch(mode)
 		{
 		case SpriteSortingMode::BackToFront:
-			std::sort(m_SpriteQueue.begin(), m_SpriteQueue.end(), [](const SpriteInfo* a, const SpriteInfo* b) -> bool
-			{
-				return a->transformPtr->GetWorldPosition().l < b->transformPtr->GetWorldPosition().l;
-			});
+		case SpriteSortingMode::TextureID:
 			break;
 		case SpriteSortingMode::FrontToBack:
-			std::sort(m_SpriteQueue.begin(), m_SpriteQueue.end(), [](const SpriteInfo* a, const SpriteInfo* b) -> bool
-			{
-				return a->transformPtr->GetWorldPosition().l > b->transformPtr->GetWorldPosition().l;
-			});
-			break;
-		case SpriteSortingMode::TextureID:
-			std::sort(m_SpriteQueue.begin(), m_SpriteQueue.end(), [](const SpriteInfo* a, const SpriteInfo* b) -> bool
-			{
-				return a->textureID < b->textureID;
-			});
+			biasedLayer = 255 - biasedLayer;
 			break;
 		default:
 			ASSERT_LOG(
 				false,
-				_T("SpriteBatch::SortSprites: Please implement this SpriteSortingMode"),
+				_T("SpriteBatch::CreateLayerKey: Please implement this SpriteSortingMode"),
 				STARENGINE_LOG_TAG
 				);
 			break;
 		}
+
+		return (hud << (SORT_HUD_SHIFT - SORT_LAYER_SHIFT)) | biasedLayer;
+	}
+
+	void SpriteBatch::RadixSortKeys()
+	{
+		//LSD radix sort, 8 bits per pass. Every pass is stable, so
+		//sprites with equal keys keep the order they were queued in.
+		//Digits that are the same for every key are skipped,
+		//in practice only a few of the 8 passes are done.
+		uint64 allOnes(~uint64(0)), anyOnes(0);
+		for(const SortEntry & entry : m_SortEntries)
+		{
+			allOnes &= entry.key;
+			anyOnes |= entry.key;
+		}
+		uint64 varyingBits = allOnes ^ anyOnes;
+
+		m_SortEntriesBuffer.resize(m_SortEntries.size());
+		uint32 offsets[RADIX_BUCKETS];
+		for(uint32 shift = 0; shift < 64; shift += RADIX_BITS)
+		{
+			if(((varyingBits >> shift) & (RADIX_BUCKETS - 1)) == 0)
+			{
+				continue;
+			}
+
+			std::fill(offsets, offsets + RADIX_BUCKETS, 0);
+			for(const SortEntry & entry : m_SortEntries)
+			{
+				++offsets[(entry.key >> shift) & (RADIX_BUCKETS - 1)];
+			}
+
+			uint32 total(0);
+			for(uint32 i = 0; i < RADIX_BUCKETS; ++i)
+			{
+				uint32 count = offsets[i];
+				offsets[i] = total;
+				total += count;
+			}
+
+			for(const SortEntry & entry : m_SortEntries)
+			{
+				m_SortEntriesBuffer[offsets[(entry.key >> shift) & (RADIX_BUCKETS - 1)]++] = entry;
+			}
+			m_SortEntries.swap(m_SortEntriesBuffer);
+		}
 	}
 
 	void SpriteBatch::AddSpriteToQueue(const SpriteInfo* spriteInfo)
 	{
-		m_SpriteQueue.push_back(spriteInfo);		
+		if(spriteInfo->bIsStatic)
+		{
+			m_StaticSpriteQueue.push_back(spriteInfo);
+		}
+		else
+		{
+			m_SpriteQueue.push_back(spriteInfo);
+		}
 	}
 
 	void SpriteBatch::AddTextToQueue(const TextInfo* text)
@@ -434,8 +1323,54 @@ namespace star
 		m_TextQueue.push_back(text);
 	}
 
+	void SpriteBatch::AddQuadBatchToQueue(const QuadBatchInfo* batch)
+	{
+		m_QuadBatchInfoQueue.push_back(batch);
+	}
+
 	void SpriteBatch::SetSpriteSortingMode(SpriteSortingMode mode)
 	{
 		m_SpriteSortingMode = mode;
 	}
+
+	void SpriteBatch::SetVertexBufferStreamingEnabled(bool enable)
+	{
+		m_bUseVertexBuffers = enable;
+	}
+
+	bool SpriteBatch::IsVertexBufferStreamingEnabled() const
+	{
+		return m_bUseVertexBuffers;
+	}
+
+	void SpriteBatch::SetInstancingEnabled(bool enable)
+	{
+		m_bInstancingEnabled = enable;
+	}
+
+	bool SpriteBatch::IsInstancingEnabled() const
+	{
+		return m_bInstancingEnabled;
+	}
+
+	bool SpriteBatch::IsInstancingActive() const
+	{
+		return m_bInstancingEnabled && m_bUseVertexBuffers
+			&& m_InstancedShaderPtr != nullptr;
+	}
+
+	void SpriteBatch::SetRenderThreadEnabled(bool enable)
+	{
+		m_bUseRenderThread = enable;
+		if(!enable)
+		{
+			//A frame that is still pending gets drawn by the next Present
+			StopRenderThread();
+		}
+	}
+
+	bool SpriteBatch::IsRenderThreadEnabled() const
+	{
+		return m_bUseRenderThread;
+	}
 }
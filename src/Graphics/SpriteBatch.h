@@ -1,19 +1,90 @@
 #pragma once
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "../defines.h"
 #include "../Helpers/Singleton.h"
 #include <memory>
 #include "Shader.h"
+#include "QuadTransform.h"
 #include "../Components/Graphics/SpriteComponent.h"
 #include "../Components/Graphics/TextComponent.h"
 
 namespace star
 {
+	//Interleaved vertex layout used by the SpriteBatch (24 bytes).
+	//The packed formats are expanded by GL when fetched, so the shader
+	//still sees a vec4 position, vec2 texCoord, vec4 colorMultiplier
+	//and a float isHUD.
+	struct SpriteVertex
+	{
+		static const uint8 HUD_FLAG = 1;
+
+		//2D position + layer depth
+		float32 x, y, layer;
+		//Normalized texture coordinates
+		uint16 u, v;
+		//RGBA8 color multiplier
+		uint8 r, g, b, a;
+		uint8 flags;
+		uint8 padding[3];
+	};
+
+	//Per sprite record of the instanced path (44 bytes).
+	//The vertex shader expands it into a quad,
+	//so a sprite costs one record instead of 4 vertices.
+	struct SpriteInstance
+	{
+		//Quad axes scaled by the sprite size:
+		//(a, b) * width and (c, d) * height of its QuadTransformInput
+		float32 axes[4];
+		//Bottom left corner + layer depth
+		float32 x, y, layer;
+		//Normalized uv rect: left, bottom, right, top
+		uint16 uvRect[4];
+		//RGBA8 color multiplier
+		uint8 r, g, b, a;
+		uint8 flags;
+		uint8 padding[3];
+	};
+
+	//A range of prebuilt quads that is owned by someone else,
+	//like a chunk of a TileLayer. It's drawn in layer order
+	//in between the sprites and its vertices have to stay valid
+	//until they're drawn, which is the next Present with the render thread.
+	struct QuadBatchInfo
+	{
+		QuadBatchInfo()
+			: vertices(nullptr)
+			, vertexBufferID(0)
+			, start(0)
+			, size(0)
+			, textureID(0)
+			, layer(0)
+			, bIsHud(false)
+		{
+
+		}
+
+		//Used when there is no vertex buffer or streaming is disabled
+		const SpriteVertex* vertices;
+		GLuint vertexBufferID;
+		//First quad and amount of quads to draw
+		uint32 start, size;
+		uint32 textureID;
+		lay layer;
+		bool bIsHud;
+	};
+
 	class SpriteBatch final : public Singleton<SpriteBatch>
 	{
 	public:
 		friend Singleton<SpriteBatch>;
 
+		//HUD sprites are always drawn after the world sprites.
+		//Sprites on the same layer keep their queue order,
+		//except in TextureID mode where they get grouped per texture.
 		enum SpriteSortingMode
 		{
 			BackToFront,
@@ -22,42 +93,239 @@ namespace star
 		};
 
 		void Initialize();
+		//[NOTE]	Without the render thread the queue is drawn right away.
+		//			With it, the queue is copied in a snapshot of which
+		//			the render thread builds the vertices while the
+		//			next frame updates. The next Present draws it.
 		void Flush();
+		//Draws the frame the render thread prepared,
+		//call it before the next frame gets queued.
+		void Present();
+		//Drops the frame waiting for Present, for when the quad batches
+		//it uses are destroyed, like the tile layers of a deleted scene.
+		void DiscardPendingFrame();
 		void AddSpriteToQueue(const SpriteInfo* spriteInfo);
 		void AddTextToQueue(const TextInfo* text);
+		void AddQuadBatchToQueue(const QuadBatchInfo* batch);
 
 		void SetSpriteSortingMode(SpriteSortingMode mode);
 
+		void SetVertexBufferStreamingEnabled(bool enable);
+		bool IsVertexBufferStreamingEnabled() const;
+
+		//Draws the dynamic sprites as instances when the context supports it.
+		//Needs vertex buffer streaming, falls back to quads otherwise.
+		void SetInstancingEnabled(bool enable);
+		bool IsInstancingEnabled() const;
+		bool IsInstancingActive() const;
+
+		//[NOTE]	Sorts the sprites and builds their vertices on a separate
+		//			thread while the next frame updates, so a frame is shown
+		//			one frame later. The GL calls stay on the thread owning
+		//			the context, as the rest of the engine uses GL there too.
+		void SetRenderThreadEnabled(bool enable);
+		bool IsRenderThreadEnabled() const;
+
+		static uint16 PackUV(float32 uv);
+		static uint8 PackColorChannel(float32 channel);
+
 	private:
+		//Values of a queued sprite, copied by Flush so the render thread
+		//never reads components that the next update is changing.
+		struct SpriteRecord
+		{
+			mat4 worldMatrix;
+			vec4 uvCoords;
+			Color colorMultiplier;
+			vec2 vertices;
+			uint32 textureID;
+			lay layer;
+			bool bIsHud;
+			//Identifies static sprites in the static cache, never dereferenced
+			const SpriteInfo* source;
+			uint32 version;
+			uint32 transformVersion;
+		};
+
+		//Values of a queued text, its glyphs are stored in the snapshot
+		struct TextRecord
+		{
+			uint32 textureID;
+			Color colorMultiplier;
+			float32 depth;
+			bool bIsHud;
+			uint32 firstGlyph;
+			uint32 glyphCount;
+		};
+
+		//Everything needed to build and draw one frame
+		struct RenderSnapshot
+		{
+			std::vector<SpriteRecord> sprites;
+			std::vector<SpriteRecord> staticSprites;
+			std::vector<TextRecord> texts;
+			std::vector<GlyphQuad> glyphs;
+			std::vector<QuadCorners> glyphCorners;
+			std::vector<QuadBatchInfo> quadBatches;
+			mat4 scaleMatrix;
+			mat4 viewInverseMatrix;
+			mat4 projectionMatrix;
+			SpriteSortingMode sortingMode;
+			bool bUseVertexBuffers;
+			bool bInstanced;
+		};
+
 		SpriteBatch();
 		~SpriteBatch();
 
-		void Begin();
+		void CaptureSnapshot(RenderSnapshot& snapshot);
+		void CaptureSprites(const std::vector<const SpriteInfo*>& queue,
+			std::vector<SpriteRecord>& records, bool bInterpolate) const;
+		//Everything but the GL calls, can run on the render thread
+		void BuildFrame(RenderSnapshot& snapshot);
+		void DrawFrame(const RenderSnapshot& snapshot);
+		void StartRenderThread();
+		void StopRenderThread();
+		void RenderThreadLoop();
+		void WaitForRenderThread();
+		void Begin(const RenderSnapshot& snapshot);
 		void End();
-		void CreateSpriteQuads();
-		void CreateTextQuads();
-		void SortSprites(SpriteSortingMode mode);
-		void DrawSprites();
+		void CreateSpriteQuads(const std::vector<SpriteRecord>& queue);
+		void InitializeInstancing();
+		void CreateSpriteInstances(const std::vector<SpriteRecord>& queue);
+		void UploadInstanceData();
+		void UseInstancedProgram(bool instanced);
+		void SetUniforms(const RenderSnapshot& snapshot, GLuint samplerID,
+			GLuint scalingID, GLuint viewInverseID, GLuint projectionID) const;
+		void FlushSpriteRange(uint32 start, uint32 size, uint32 texture);
+		void FlushSpriteInstances(uint32 start, uint32 size, uint32 texture);
+		void CreateTextQuads(const RenderSnapshot& snapshot);
+		void SortSprites(std::vector<SpriteRecord>& queue, SpriteSortingMode mode);
+		uint64 CreateSortKey(const SpriteRecord& sprite, SpriteSortingMode mode) const;
+		static uint32 CreateLayerKey(bool isHud, lay layer, SpriteSortingMode mode);
+		void RadixSortKeys();
+		void DrawSprites(const std::vector<SpriteRecord>& queue);
+		bool IsStaticCacheValid(const std::vector<SpriteRecord>& queue) const;
+		void RebuildStaticSprites(std::vector<SpriteRecord>& queue);
+		void UploadStaticVertexData();
+		void QueueQuadBatches(const std::vector<QuadBatchInfo>& infos);
+		uint32 DrawQuadBatches(uint32 firstBatch, uint32 maxLayerKey);
+		void SetVertexSource(GLuint vertexBufferID, const SpriteVertex* vertices);
+		void SetDynamicVertexSource();
 		void FlushSprites(uint32 start, uint32 size, uint32 texture);
-		void DrawTextSprites();
+		void DrawTextSprites(const std::vector<TextRecord>& texts);
+		void UploadVertexData();
+		void CreateIndexBuffer();
+		void SetVertexAttribPointers(uint32 firstVertex);
+		void DrawQuads(uint32 start, uint32 size);
+		void SetVertexInfo(SpriteVertex& vertex, const Color& color, bool isHUD) const;
+		void PushVertex(SpriteVertex& vertex, uint16 u, uint16 v);
+		void TransformQuads(uint32 firstVertex);
+
 
 		static const uint32 BATCHSIZE = 50;
+		static const uint32 VERTEX_BUFFER_COUNT = 3;
+		static const uint32 VERTICES_PER_QUAD = 4;
+		static const uint32 INDICES_PER_QUAD = 6;
+		//Largest batch the uint16 index buffer can address
+		static const uint32 MAX_QUADS_PER_DRAW = 65536 / VERTICES_PER_QUAD;
 		static const uint32 VERTEX_AMOUNT = 18;
 		static const uint32 UV_AMOUNT = 12;
-		static const uint32 FIRST_REAL_ASCII_CHAR = 31;
+		static const uint32 SNAPSHOT_COUNT = 2;
+
+		//Sort key layout, from the most significant bit down:
+		//[63] HUD | [62-55] layer | [54-48] material | [47-16] texture
+		static const uint32 SORT_HUD_SHIFT = 63;
+		static const uint32 SORT_LAYER_SHIFT = 55;
+		static const uint32 SORT_MATERIAL_SHIFT = 48;
+		static const uint32 SORT_TEXTURE_SHIFT = 16;
+		static const uint32 RADIX_BITS = 8;
+		static const uint32 RADIX_BUCKETS = 1 << RADIX_BITS;
+
+		struct SortEntry
+		{
+			uint64 key;
+			uint32 index;
+		};
+
+		//State of a static sprite when the static cache was built
+		struct StaticSpriteState
+		{
+			const SpriteInfo* sprite;
+			uint32 version;
+			uint32 transformVersion;
+		};
+
+		//Range of retained quads sharing the same HUD/layer key and texture
+		struct QuadBatch
+		{
+			uint32 layerKey;
+			uint32 texture;
+			GLuint vertexBufferID;
+			const SpriteVertex* vertices;
+			uint32 start;
+			uint32 size;
+		};
 
 		std::vector<const SpriteInfo*> m_SpriteQueue;
 		std::vector<const TextInfo*> m_TextQueue;
+		//Scratch buffers of the sort stage, kept to avoid reallocations
+		std::vector<SortEntry> m_SortEntries,
+							   m_SortEntriesBuffer;
+		std::vector<SpriteRecord> m_SortedSpriteQueue;
+		//Retained static sprites, only rebuilt when one of them changes
+		std::vector<const SpriteInfo*> m_StaticSpriteQueue;
+		std::vector<StaticSpriteState> m_StaticSpriteStates;
+		std::vector<QuadBatch> m_StaticBatches;
+		std::vector<SpriteVertex> m_StaticVertexBuffer;
+		GLuint m_StaticVertexBufferID;
+		SpriteSortingMode m_StaticSortingMode;
+		bool m_bStaticInVertexBuffer;
+		//Set when the static cache was rebuilt, uploaded by the next draw
+		bool m_bStaticUploadPending;
+		//Static batches and external quad batches of this frame, in layer order
+		std::vector<const QuadBatchInfo*> m_QuadBatchInfoQueue;
+		std::vector<QuadBatch> m_QuadBatchQueue;
+		//Vertices the attribute pointers currently point to
+		GLuint m_SourceVertexBufferID;
+		const SpriteVertex* m_SourceVertices;
+		//Index of the first text quad in the vertexbuffer
+		uint32 m_FirstTextQuad;
+
+		//Flush fills one snapshot while the other one can still be built
+		RenderSnapshot m_Snapshots[SNAPSHOT_COUNT];
+		uint32 m_QueueSnapshot;
+		//Built or being built, drawn by the next Present
+		RenderSnapshot* m_pPresentSnapshot;
+		std::thread m_RenderThread;
+		std::mutex m_RenderMutex;
+		std::condition_variable m_RenderCondition;
+		//Guarded by m_RenderMutex, null when the render thread is idle
+		RenderSnapshot* m_pBuildSnapshot;
+		bool m_bStopRenderThread;
+		bool m_bUseRenderThread;
 
-		//[TODO] Check if can be changed to vector<vec4 or vec2>
-		std::vector<vec4> m_VertexBuffer;
-		std::vector<float32> m_UvCoordBuffer;
-		std::vector<float32> m_IsHUDBuffer;
-		std::vector<Color> m_ColorBuffer;
+		std::vector<SpriteVertex> m_VertexBuffer;
+		//Transforms of the quads pushed since the last TransformQuads call
+		std::vector<QuadTransformInput> m_QuadInputs;
+		std::vector<QuadCorners> m_QuadCorners;
 		
 		GLuint m_VertexID,
 			   m_UVID,
 			   m_IsHUDID;
+		//Attribute arrays of the sprite program, see GLStateCache
+		uint32 m_VertexAttribMask;
+
+		//Streaming vertex buffers, used round-robin and orphaned every frame
+		GLuint m_VertexBufferIDs[VERTEX_BUFFER_COUNT];
+		uint32 m_VertexBufferSizes[VERTEX_BUFFER_COUNT];
+		uint32 m_CurrentVertexBuffer;
+
+		//Shared static index buffer, 6 indices for every 4 quad vertices
+		std::vector<uint16> m_IndexBuffer;
+		GLuint m_IndexBufferID;
+		uint32 m_CurrentQuadPage;
+		bool m_bUseVertexBuffers;
 
 		GLuint	m_TextureSamplerID,
 				m_ColorID,
@@ -67,6 +335,33 @@ namespace star
 
 		Shader* m_ShaderPtr;	
 
+		//Instanced path, only created when the context supports it
+		Shader* m_InstancedShaderPtr;
+		GLuint	m_InstanceCornerID,
+				m_InstanceAxesID,
+				m_InstanceOriginID,
+				m_InstanceUVID,
+				m_InstanceColorID,
+				m_InstanceIsHUDID,
+				m_InstanceTextureSamplerID,
+				m_InstanceScalingID,
+				m_InstanceViewInverseID,
+				m_InstanceProjectionID;
+		uint32 m_InstanceAttribMask;
+		//Unit quad corners shared by all instances
+		GLuint m_CornerBufferID;
+		GLuint m_InstanceBufferIDs[VERTEX_BUFFER_COUNT];
+		uint32 m_InstanceBufferSizes[VERTEX_BUFFER_COUNT];
+		uint32 m_CurrentInstanceBuffer;
+		std::vector<SpriteInstance> m_InstanceBuffer;
+		bool m_bInstancingEnabled;
+		//Settings of the frame being built and drawn, taken from its snapshot.
+		//A frame is always drawn before the next one gets built.
+		bool m_bInstancedFrame;
+		bool m_bStreamingFrame;
+		SpriteSortingMode m_FrameSortingMode;
+		bool m_bInstancedProgramBound;
+
 		SpriteSortingMode m_SpriteSortingMode;
 
 		SpriteBatch(const SpriteBatch& yRef);
@@ -1,16 +1,44 @@
 #include "Texture2D.h"
 #include <png.h>
 #include "../Helpers/Helpers.h"
+#include "TextureAtlas.h"
+#include "GLStateCache.h"
+#include "GraphicsManager.h"
+#include "TextureCompression.h"
+#include <algorithm>
+#include <limits>
+#include <string.h>
 
 namespace star
 {
 	const tstring Texture2D::LIBPNG_LOG_TAG = _T("LIBPNG");
 
-	Texture2D::Texture2D(const tstring & pPath)
+	Texture2D::ImageData::ImageData()
+		: pixels(nullptr)
+		, format(0)
+		, width(0)
+		, height(0)
+		, sourceWidth(0)
+		, sourceHeight(0)
+		, levels()
+		, isCompressed(false)
+		, error()
+	{
+
+	}
+
+	Texture2D::Texture2D(const tstring & pPath, TextureAtlas* pAtlas)
 			: mTextureId(0)
 			, mFormat(0)
 			, mWidth(0)
 			, mHeight(0)
+			, mAtlas(pAtlas)
+			, mUVRegion(0, 0, 1, 1)
+			, mIsAtlasTexture(false)
+			, mMemorySize(0)
+			, mScale(1.0f)
+			, mState(State::Pending)
+			, mImage()
 #ifdef ANDROID
 			, mResource(pPath)
 #else
@@ -19,6 +47,40 @@ namespace star
 	{
 		Load();
 	}
+
+	Texture2D::Texture2D(
+		const tstring & pPath,
+		TextureAtlas* pAtlas,
+		bool deferLoading,
+		float32 scale
+		)
+			: mTextureId(0)
+			, mFormat(0)
+			, mWidth(0)
+			, mHeight(0)
+			, mAtlas(pAtlas)
+			, mUVRegion(0, 0, 1, 1)
+			, mIsAtlasTexture(false)
+			, mMemorySize(0)
+			, mScale(scale)
+			, mState(State::Pending)
+			, mImage()
+#ifdef ANDROID
+			, mResource(pPath)
+#else
+			, mPath(pPath)
+#endif
+	{
+		if(!deferLoading)
+		{
+			Load();
+		}
+		else
+		{
+			//An unreadable header is reported when decoding fails
+			ReadImageHeader(GetPath(), mWidth, mHeight);
+		}
+	}
 #ifdef ANDROID
 	void Texture2D::CallbackRead(png_structp png, png_bytep data, png_size_t size)
 	{
@@ -33,17 +95,440 @@ namespace star
 
 	Texture2D::~Texture2D()
 	{
-		if(mTextureId != 0)
+		//Atlas pages are owned by the atlas
+		if(mTextureId != 0 && !mIsAtlasTexture)
 		{
-			glDeleteTextures(1, &mTextureId);
+			GLStateCache::GetInstance()->DeleteTextures(1, &mTextureId);
 			mTextureId = 0;
 		}
+		else if(mIsAtlasTexture && mAtlas != nullptr)
+		{
+			mAtlas->Release(mTextureId, mUVRegion);
+		}
+		delete [] mImage.pixels;
+		mImage.pixels = nullptr;
 		mWidth = 0;
 		mHeight = 0;
 		mFormat = 0;
 	}
+
+	bool Texture2D::ReadImageHeader(const tstring & path, int32 & width, int32 & height) const
+	{
+		//Large enough for the size fields of all supported files
+		uint8 header[44];
+#ifdef DESKTOP
+		FILE *fp;
+		tfopen(&fp, path.c_str(), _T("rb"));
+		if(fp == NULL)
+		{
+			return false;
+		}
+		bool isRead = fread(header, sizeof(header), 1, fp) == 1;
+		fclose(fp);
+#else
+		Resource resource(path);
+		bool isRead = resource.Open() && resource.Read(header, sizeof(header));
+		resource.Close();
+#endif
+		if(!isRead)
+		{
+			return false;
+		}
+
+		switch(GetFileType())
+		{
+		case FileType::KTX:
+			width = ReadUInt32(header + 36);
+			height = ReadUInt32(header + 40);
+			return true;
+		case FileType::DDS:
+			height = ReadUInt32(header + 12);
+			width = ReadUInt32(header + 16);
+			return true;
+		default:
+			//Signature, length and type of the IHDR chunk,
+			//followed by the big endian width and height
+			if(png_sig_cmp(header, 0, 8))
+			{
+				return false;
+			}
+			width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+			height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+			return true;
+		}
+	}
+
+	Texture2D::FileType Texture2D::GetFileType() const
+	{
+		const tstring & path = GetPath();
+		size_t dot = path.find_last_of(_T('.'));
+		if(dot == tstring::npos)
+		{
+			return FileType::PNG;
+		}
+
+		tstring extension = path.substr(dot + 1);
+		if(extension == _T("ktx") || extension == _T("KTX"))
+		{
+			return FileType::KTX;
+		}
+		if(extension == _T("dds") || extension == _T("DDS"))
+		{
+			return FileType::DDS;
+		}
+		return FileType::PNG;
+	}
+
+	bool Texture2D::ReadFile(const tstring & path, std::vector<uint8> & data, tstring & error) const
+	{
+#ifdef DESKTOP
+		FILE *fp;
+		tfopen(&fp, path.c_str(), _T("rb"));
+		if(fp == NULL)
+		{
+			error = _T("Texture2D::ReadFile: \"") + path + _T("\" could not be loaded");
+			return false;
+		}
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		data.resize(size > 0 ? size : 0);
+		bool isRead = size > 0 && fread(&data[0], size, 1, fp) == 1;
+		fclose(fp);
+#else
+		Resource resource(path);
+		if(!resource.Open())
+		{
+			resource.Close();
+			error = _T("Texture2D::ReadFile: Could Not Open Resource");
+			return false;
+		}
+		off_t size = resource.GetLength();
+		data.resize(size > 0 ? size : 0);
+		bool isRead = size > 0 && resource.Read(&data[0], size);
+		resource.Close();
+#endif
+		if(!isRead)
+		{
+			error = _T("Texture2D::ReadFile: Could Not Read \"") + path + _T("\"");
+		}
+		return isRead;
+	}
+
+	bool Texture2D::ReadKTX(const tstring & path, ImageData & image)
+	{
+		static const uint8 IDENTIFIER[12] =
+		{
+			0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+		};
+		static const uint32 HEADER_SIZE = 64;
+		static const uint32 ENDIANNESS = 0x04030201;
+
+		std::vector<uint8> data;
+		if(!ReadFile(path, data, image.error))
+		{
+			return false;
+		}
+		if(data.size() < HEADER_SIZE || memcmp(&data[0], IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+		{
+			image.error = _T("KTX : Not a KTX 1.1 file");
+			return false;
+		}
+		if(ReadUInt32(&data[12]) != ENDIANNESS)
+		{
+			image.error = _T("KTX : Big endian files are not supported");
+			return false;
+		}
+
+		uint32 glType = ReadUInt32(&data[16]);
+		GLenum format = ReadUInt32(&data[28]);
+		int32 width = ReadUInt32(&data[36]);
+		int32 height = ReadUInt32(&data[40]);
+		uint32 depth = ReadUInt32(&data[44]);
+		uint32 arrayElements = ReadUInt32(&data[48]);
+		uint32 faces = ReadUInt32(&data[52]);
+		uint32 levelCount = std::max<uint32>(ReadUInt32(&data[56]), 1);
+		uint32 keyValueBytes = ReadUInt32(&data[60]);
+
+		if(glType != 0 || !TextureCompression::IsSupportedFormat(format))
+		{
+			image.error = _T("KTX : Only ETC1, ETC2 and S3TC data is supported");
+			return false;
+		}
+		if(depth > 1 || arrayElements > 0 || faces != 1 || width <= 0 || height <= 0)
+		{
+			image.error = _T("KTX : Only 2D textures are supported");
+			return false;
+		}
+		if(!IsValidImageSize(width, height, levelCount))
+		{
+			image.error = _T("KTX : The size or level count exceeds GL_MAX_TEXTURE_SIZE");
+			return false;
+		}
+
+		image.format = format;
+		image.width = width;
+		image.height = height;
+
+		//Every level is prefixed with its size and padded to 4 bytes.
+		//Offsets are 64 bit so a bogus size can't wrap around the file length.
+		uint64 offset = uint64(HEADER_SIZE) + keyValueBytes;
+		for(uint32 i = 0; i < levelCount; ++i)
+		{
+			MipLevel level;
+			level.width = std::max(width >> i, 1);
+			level.height = std::max(height >> i, 1);
+			uint64 levelSize = TextureCompression::GetImageSize(format, level.width, level.height);
+			if(offset + 4 > data.size())
+			{
+				break;
+			}
+			uint64 imageSize = ReadUInt32(&data[size_t(offset)]);
+			offset += 4;
+			if(imageSize < levelSize || offset + levelSize > data.size())
+			{
+				break;
+			}
+			level.offset = uint32(offset);
+			level.size = uint32(levelSize);
+			image.levels.push_back(level);
+			offset += (imageSize + 3) & ~uint64(3);
+		}
+
+		if(image.levels.empty())
+		{
+			image.error = _T("KTX : The file is truncated");
+			return false;
+		}
+
+		StoreLevels(data, image);
+		return true;
+	}
+
+	bool Texture2D::ReadDDS(const tstring & path, ImageData & image)
+	{
+		static const uint32 HEADER_SIZE = 128;
+		static const uint32 DX10_HEADER_SIZE = 20;
+		static const uint32 DDSD_MIPMAPCOUNT = 0x20000;
+		static const uint32 DDPF_ALPHAPIXELS = 0x1;
+		static const uint32 DDPF_FOURCC = 0x4;
+		static const uint32 DDSCAPS2_CUBEMAP = 0x200;
+		static const uint32 DDSCAPS2_VOLUME = 0x200000;
+
+		std::vector<uint8> data;
+		if(!ReadFile(path, data, image.error))
+		{
+			return false;
+		}
+		if(data.size() < HEADER_SIZE || memcmp(&data[0], "DDS ", 4) != 0)
+		{
+			image.error = _T("DDS : Not a DDS file");
+			return false;
+		}
+
+		uint32 flags = ReadUInt32(&data[8]);
+		int32 height = ReadUInt32(&data[12]);
+		int32 width = ReadUInt32(&data[16]);
+		uint32 levelCount = (flags & DDSD_MIPMAPCOUNT) != 0 ?
+			std::max<uint32>(ReadUInt32(&data[28]), 1) : 1;
+		uint32 formatFlags = ReadUInt32(&data[80]);
+		const uint8* fourCC = &data[84];
+		uint32 caps2 = ReadUInt32(&data[112]);
+
+		if((caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) != 0 || width <= 0 || height <= 0)
+		{
+			image.error = _T("DDS : Only 2D textures are supported");
+			return false;
+		}
+		if(!IsValidImageSize(width, height, levelCount))
+		{
+			image.error = _T("DDS : The size or level count exceeds GL_MAX_TEXTURE_SIZE");
+			return false;
+		}
+
+		GLenum format(0);
+		size_t offset = HEADER_SIZE;
+		if((formatFlags & DDPF_FOURCC) == 0)
+		{
+			//Uncompressed data, left as unsupported
+		}
+		else if(memcmp(fourCC, "DXT1", 4) == 0)
+		{
+			format = (formatFlags & DDPF_ALPHAPIXELS) != 0 ?
+				GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		}
+		else if(memcmp(fourCC, "DXT3", 4) == 0)
+		{
+			format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		}
+		else if(memcmp(fourCC, "DXT5", 4) == 0)
+		{
+			format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if(memcmp(fourCC, "DX10", 4) == 0
+			&& data.size() >= HEADER_SIZE + DX10_HEADER_SIZE
+			&& ReadUInt32(&data[HEADER_SIZE + 12]) == 1)
+		{
+			//BC1, BC2 and BC3, typeless and unorm or srgb
+			switch(ReadUInt32(&data[HEADER_SIZE]))
+			{
+			case 70: case 71: case 72:
+				format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+				break;
+			case 73: case 74: case 75:
+				format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+				break;
+			case 76: case 77: case 78:
+				format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+				break;
+			}
+			offset += DX10_HEADER_SIZE;
+		}
+
+		if(format == 0)
+		{
+			image.error = _T("DDS : Only DXT1, DXT3 and DXT5 data is supported");
+			return false;
+		}
+
+		image.format = format;
+		image.width = width;
+		image.height = height;
+
+		//Levels are stored back to back without any padding
+		for(uint32 i = 0; i < levelCount; ++i)
+		{
+			MipLevel level;
+			level.width = std::max(width >> i, 1);
+			level.height = std::max(height >> i, 1);
+			uint64 levelSize = TextureCompression::GetImageSize(format, level.width, level.height);
+			if(offset + levelSize > data.size())
+			{
+				break;
+			}
+			level.offset = uint32(offset);
+			level.size = uint32(levelSize);
+			image.levels.push_back(level);
+			offset += level.size;
+		}
+
+		if(image.levels.empty())
+		{
+			image.error = _T("DDS : The file is truncated");
+			return false;
+		}
+
+		StoreLevels(data, image);
+
+		//DDS is stored top down while the engine uploads bottom up like the pngs.
+		//Levels that can't be flipped exactly are dropped.
+		for(uint32 i = 0; i < image.levels.size(); ++i)
+		{
+			const MipLevel & level = image.levels[i];
+			if(!TextureCompression::FlipS3TCImage(format,
+				image.pixels + level.offset, level.width, level.height))
+			{
+				if(i == 0)
+				{
+					delete [] image.pixels;
+					image.pixels = nullptr;
+					image.levels.clear();
+					image.error = _T("DDS : The height has to be a multiple of 4");
+					return false;
+				}
+				image.levels.resize(i);
+				break;
+			}
+		}
+		return true;
+	}
+
+	void Texture2D::StoreLevels(const std::vector<uint8> & data, ImageData & image) const
+	{
+		uint32 totalSize(0);
+		for(const MipLevel & level : image.levels)
+		{
+			totalSize += level.size;
+		}
+
+		image.pixels = new uint8[totalSize];
+		uint32 offset(0);
+		for(MipLevel & level : image.levels)
+		{
+			memcpy(image.pixels + offset, &data[level.offset], level.size);
+			level.offset = offset;
+			offset += level.size;
+		}
+	}
+
+	bool Texture2D::PrepareCompressedImage(ImageData & image) const
+	{
+		GraphicsManager* graphics = GraphicsManager::GetInstance();
+		//ETC2 is a superset of ETC1
+		if(image.format == GL_ETC1_RGB8_OES
+			&& graphics->IsCompressedTextureFormatSupported(GL_COMPRESSED_RGB8_ETC2))
+		{
+			image.format = GL_COMPRESSED_RGB8_ETC2;
+		}
+
+		if(graphics->IsCompressedTextureFormatSupported(image.format))
+		{
+			image.isCompressed = true;
+			return true;
+		}
+
+		uint64 totalSize(0);
+		for(const MipLevel & level : image.levels)
+		{
+			totalSize += uint64(level.width) * level.height * 4;
+		}
+		if(totalSize > std::numeric_limits<uint32>::max()
+			|| totalSize > std::numeric_limits<size_t>::max())
+		{
+			delete [] image.pixels;
+			image.pixels = nullptr;
+			image.levels.clear();
+			image.error = _T("Texture2D : The image is too large to decompress");
+			return false;
+		}
+
+		uint8* pixels = new uint8[size_t(totalSize)];
+		uint32 offset(0);
+		for(MipLevel & level : image.levels)
+		{
+			TextureCompression::Decompress(image.format,
+				image.pixels + level.offset, level.width, level.height,
+				pixels + offset);
+			level.offset = offset;
+			level.size = level.width * level.height * 4;
+			offset += level.size;
+		}
+
+		delete [] image.pixels;
+		image.pixels = pixels;
+		image.format = GL_RGBA;
+		image.isCompressed = false;
+		return true;
+	}
+
+	uint32 Texture2D::ReadUInt32(const uint8* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+	}
+
+	bool Texture2D::IsValidImageSize(int32 width, int32 height, uint32 levelCount)
+	{
+		int32 maxSize = GraphicsManager::GetInstance()->GetMaxTextureSize();
+		//log2(maxSize) + 1 levels down to 1x1
+		uint32 maxLevels(1);
+		while((maxSize >> maxLevels) > 0)
+		{
+			++maxLevels;
+		}
+		return width <= maxSize && height <= maxSize && levelCount <= maxLevels;
+	}
 	
-	uint8* Texture2D::ReadPNG()
+	bool Texture2D::ReadPNG(const tstring & path, ImageData & image)
 	{
 		png_byte header[8];
 		png_structp lPngPtr = NULL;
@@ -55,43 +540,37 @@ namespace star
 
 #ifdef DESKTOP
 		FILE *fp;
-		tfopen(&fp, mPath.c_str(), _T("rb"));
+		tfopen(&fp, path.c_str(), _T("rb"));
 
 		if(fp == NULL)
 		{ 
-			LOG(LogLevel::Error,
-				_T("Texture2D::ReadPNG: the png \"") +
-				mPath + 
-				_T("\" could not be loaded"), LIBPNG_LOG_TAG
-				);
-			return NULL;
+			image.error = _T("Texture2D::ReadPNG: the png \"") +
+				path + 
+				_T("\" could not be loaded");
+			return false;
 		}
 
 		fread(header, 8, 1, fp);
 #else
-		if(!mResource.Open())
+		Resource resource(path);
+		if(!resource.Open())
 		{
-			mResource.Close();
-			LOG(LogLevel::Error,
-				_T("PNG : Could Not Open Resource"), LIBPNG_LOG_TAG);
-			return NULL;
+			resource.Close();
+			image.error = _T("PNG : Could Not Open Resource");
+			return false;
 		}
-		if(!mResource.Read(header, sizeof(header)))
+		if(!resource.Read(header, sizeof(header)))
 		{
-			mResource.Close();
-			LOG(LogLevel::Error,
-				_T("PNG : Could Not Read"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			resource.Close();
+			image.error = _T("PNG : Could Not Read");
+			return false;
 		}
 #endif
 
 		if(png_sig_cmp(header, 0, 8))
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : Not a PNG file"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : Not a PNG file");
+			return false;
 		}
 		lPngPtr = png_create_read_struct(
 			PNG_LIBPNG_VER_STRING,
@@ -101,38 +580,33 @@ namespace star
 			);
 		if(!lPngPtr)
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : create struct string failed"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : create struct string failed");
+			return false;
 		}
 
-		png_set_error_fn(lPngPtr, NULL, CustomErrorFunction, CustomWarningFunction);
+		png_set_error_fn(lPngPtr, &image, CustomErrorFunction, CustomWarningFunction);
 
 		lInfoPtr = png_create_info_struct(lPngPtr);
 		if(!lInfoPtr)
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : create info failed"), LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : create info failed");
+			return false;
 		}
 
 #ifdef DESKTOP
 		png_init_io(lPngPtr, fp);
 		if(setjmp(png_jmpbuf(lPngPtr)))
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : Error during init io"), LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : Error during init io");
+			return false;
 		}
 #else
-		png_set_read_fn(lPngPtr, &mResource, CallbackRead);
+		png_set_read_fn(lPngPtr, &resource, CallbackRead);
 		if(setjmp(png_jmpbuf(lPngPtr)))
 		{
-			mResource.Close();
-			LOG(LogLevel::Error,
-				_T("PNG : Error during init io"), LIBPNG_LOG_TAG);
-			return NULL;
+			resource.Close();
+			image.error = _T("PNG : Error during init io");
+			return false;
 		}
 #endif
 		png_set_sig_bytes(lPngPtr, 8);
@@ -151,8 +625,8 @@ namespace star
 			NULL,
 			NULL
 			);
-		mWidth = pWidth;
-		mHeight = pHeight;
+		image.width = pWidth;
+		image.height = pHeight;
 
 		lTransparency = false;
 		if(png_get_valid(lPngPtr, lInfoPtr, PNG_INFO_tRNS))
@@ -161,7 +635,7 @@ namespace star
 			lTransparency=true;
 
 #ifdef ANDROID
-			mResource.Close();
+			resource.Close();
 #endif
 			delete [] lRowPtrs;
 			delete [] lImageBuffer;
@@ -170,7 +644,8 @@ namespace star
 				png_infop* lInfoPtrP = lInfoPtr != NULL ? &lInfoPtr: NULL;
 				png_destroy_read_struct(&lPngPtr, lInfoPtrP, NULL);
 			}
-			return NULL;
+			image.error = _T("PNG : tRNS transparency is not supported");
+			return false;
 		}
 
 		if(lDepth < 8 )
@@ -186,21 +661,21 @@ namespace star
 		{
 		case PNG_COLOR_TYPE_PALETTE:
 			png_set_palette_to_rgb(lPngPtr);
-			mFormat = lTransparency ? GL_RGBA : GL_RGB;
+			image.format = lTransparency ? GL_RGBA : GL_RGB;
 			break;
 		case PNG_COLOR_TYPE_RGB:
-			mFormat = lTransparency ? GL_RGBA : GL_RGB;
+			image.format = lTransparency ? GL_RGBA : GL_RGB;
 			break;
 		case PNG_COLOR_TYPE_RGBA:
-			mFormat = GL_RGBA;
+			image.format = GL_RGBA;
 			break;
 		case PNG_COLOR_TYPE_GRAY:
 			png_set_expand_gray_1_2_4_to_8(lPngPtr);
-			mFormat = lTransparency ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+			image.format = lTransparency ? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
 			break;
 		case PNG_COLOR_TYPE_GA:
 			png_set_expand_gray_1_2_4_to_8(lPngPtr);
-			mFormat = GL_LUMINANCE_ALPHA;
+			image.format = GL_LUMINANCE_ALPHA;
 			break;
 		}
 
@@ -217,28 +692,22 @@ namespace star
 		lRowSize = png_get_rowbytes(lPngPtr,lInfoPtr);
 		if(lRowSize <= 0)
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : png rowsize smaller or equal to 0"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : png rowsize smaller or equal to 0");
+			return false;
 		}
 
 		lImageBuffer = new png_byte[lRowSize * pHeight];
 		if(!lImageBuffer)
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : Error during image buffer creation"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : Error during image buffer creation");
+			return false;
 		}
 
 		lRowPtrs = new png_bytep[pHeight];
 		if(!lRowPtrs)
 		{
-			LOG(LogLevel::Error,
-				_T("PNG : Error during row pointer creation"),
-				LIBPNG_LOG_TAG);
-			return NULL;
+			image.error = _T("PNG : Error during row pointer creation");
+			return false;
 		}
 
 		for(uint32 i = 0; i < pHeight; ++i)
@@ -249,11 +718,195 @@ namespace star
 #ifdef DESKTOP
 		fclose(fp);
 #else
-		mResource.Close();
+		resource.Close();
 #endif
 		png_destroy_read_struct(&lPngPtr, &lInfoPtr, NULL);
 		delete[] lRowPtrs;
 
+		image.pixels = lImageBuffer;
+		return true;
+	}
+
+	void Texture2D::Load()
+	{
+		Decode();
+		Upload();
+	}
+
+	bool Texture2D::Decode()
+	{
+		//A pre-baked variant is used as is,
+		//the original file only tells the size to report.
+		tstring path = GetPath();
+		int32 steps = GetScaleSteps(mScale);
+		int32 fileSteps(0);
+		if(steps > 0)
+		{
+			tstring variantPath = GetVariantPath(path, steps);
+			int32 width, height;
+			if(ReadImageHeader(variantPath, width, height)
+				&& ReadImageHeader(path, mImage.sourceWidth, mImage.sourceHeight))
+			{
+				path = variantPath;
+				fileSteps = steps;
+			}
+		}
+
+		bool isRead(false);
+		switch(GetFileType())
+		{
+		case FileType::KTX:
+			isRead = ReadKTX(path, mImage) && PrepareCompressedImage(mImage);
+			break;
+		case FileType::DDS:
+			isRead = ReadDDS(path, mImage) && PrepareCompressedImage(mImage);
+			break;
+		default:
+			isRead = ReadPNG(path, mImage);
+			break;
+		}
+		if(!isRead)
+		{
+			return false;
+		}
+
+		if(fileSteps == 0)
+		{
+			mImage.sourceWidth = mImage.width;
+			mImage.sourceHeight = mImage.height;
+		}
+		ScaleImage(mImage, steps - fileSteps);
+		return true;
+	}
+
+	void Texture2D::ScaleImage(ImageData & image, int32 steps) const
+	{
+		if(steps <= 0)
+		{
+			return;
+		}
+
+		//Files with mip levels already have the smaller sizes,
+		//compressed data can't be filtered without decompressing it.
+		if(!image.levels.empty())
+		{
+			uint32 dropped = std::min<uint32>(steps, image.levels.size() - 1);
+			image.levels.erase(image.levels.begin(), image.levels.begin() + dropped);
+			image.width = image.levels[0].width;
+			image.height = image.levels[0].height;
+			return;
+		}
+
+		int32 components = GetComponentCount(image.format);
+		for(int32 i = 0; i < steps && (image.width > 1 || image.height > 1); ++i)
+		{
+			uint8* pixels = HalveImage(image.pixels, image.width, image.height, components);
+			delete [] image.pixels;
+			image.pixels = pixels;
+			image.width = (image.width + 1) / 2;
+			image.height = (image.height + 1) / 2;
+		}
+	}
+
+	uint8* Texture2D::HalveImage(
+		const uint8* pixels,
+		int32 width,
+		int32 height,
+		int32 components
+		)
+	{
+		int32 halfWidth = (width + 1) / 2;
+		int32 halfHeight = (height + 1) / 2;
+		uint8* half = new uint8[halfWidth * halfHeight * components];
+		for(int32 y = 0; y < halfHeight; ++y)
+		{
+			const uint8* row0 = pixels + (y * 2) * width * components;
+			const uint8* row1 = pixels + std::min(y * 2 + 1, height - 1) * width * components;
+			for(int32 x = 0; x < halfWidth; ++x)
+			{
+				int32 x0 = x * 2 * components;
+				int32 x1 = std::min(x * 2 + 1, width - 1) * components;
+				uint8* dst = half + (x + y * halfWidth) * components;
+				for(int32 c = 0; c < components; ++c)
+				{
+					dst[c] = uint8((row0[x0 + c] + row0[x1 + c]
+						+ row1[x0 + c] + row1[x1 + c] + 2) / 4);
+				}
+			}
+		}
+		return half;
+	}
+
+	int32 Texture2D::GetComponentCount(GLint format)
+	{
+		switch(format)
+		{
+		case GL_RGBA:
+			return 4;
+		case GL_RGB:
+			return 3;
+		case GL_LUMINANCE_ALPHA:
+			return 2;
+		default:
+			return 1;
+		}
+	}
+
+	int32 Texture2D::GetScaleSteps(float32 scale)
+	{
+		int32 steps(0);
+		while(scale < 0.75f && steps < 2)
+		{
+			scale *= 2.0f;
+			++steps;
+		}
+		return steps;
+	}
+
+	tstring Texture2D::GetVariantPath(const tstring & path, int32 steps)
+	{
+		//'textures/hero.png' becomes 'textures/hero@0.5x.png'
+		tstring suffix = steps == 1 ? _T("@0.5x") : _T("@0.25x");
+		size_t dot = path.find_last_of(_T('.'));
+		size_t slash = path.find_last_of(_T("/\\"));
+		if(dot == tstring::npos || (slash != tstring::npos && dot < slash))
+		{
+			return path + suffix;
+		}
+		return path.substr(0, dot) + suffix + path.substr(dot);
+	}
+
+	void Texture2D::Upload()
+	{
+		if(mState != State::Pending)
+		{
+			return;
+		}
+
+		uint8* lImageBuffer = mImage.pixels;
+		mImage.pixels = nullptr;
+		if(lImageBuffer == NULL)
+		{
+			if(!mImage.error.empty())
+			{
+				LOG(LogLevel::Error, mImage.error, LIBPNG_LOG_TAG);
+			}
+			LOG(LogLevel::Error, 
+				_T("PNG : READING PNG FAILED - NO IMAGE BUFFER"), LIBPNG_LOG_TAG);
+			mWidth = 0;
+			mHeight = 0;
+			mState = State::Failed;
+			return;
+		}
+
+		//Variants are drawn at the size of the original file
+		mWidth = mImage.sourceWidth;
+		mHeight = mImage.sourceHeight;
+		mFormat = mImage.format;
+		mState = State::Ready;
+		int32 width = mImage.width;
+		int32 height = mImage.height;
+
 #ifdef DESKTOP
 		DEBUG_LOG(LogLevel::Info,
 			_T("PNG : ") + mPath + _T(" Created Succesfull"),
@@ -263,29 +916,57 @@ namespace star
 					_T("PNG : ") + mResource.GetPath() + _T(" Created Succesfull"),
 					LIBPNG_LOG_TAG);
 #endif
-		return lImageBuffer;
 
-	}
-
-	void Texture2D::Load()
-	{
-		uint8* lImageBuffer = ReadPNG();
-		if(lImageBuffer == NULL)
+		const std::vector<MipLevel> & levels = mImage.levels;
+		if(levels.empty() && mAtlas != nullptr &&
+			mAtlas->Insert(lImageBuffer, mFormat, width, height, mTextureId, mUVRegion))
 		{
-			LOG(LogLevel::Error, 
-				_T("PNG : READING PNG FAILED - NO IMAGE BUFFER"), LIBPNG_LOG_TAG);
+			mIsAtlasTexture = true;
+			delete[] lImageBuffer;
 			return;
 		}
 
+		//Mipmap filtering needs every level down to 1x1
+		uint32 fullLevelCount(1);
+		while((std::max(width, height) >> fullLevelCount) > 0)
+		{
+			++fullLevelCount;
+		}
+		bool isMipmapped = levels.size() > 1 && levels.size() >= fullLevelCount;
+
 		glGenTextures(1, &mTextureId);
-		glBindTexture(GL_TEXTURE_2D, mTextureId);
+		GLStateCache::GetInstance()->BindTexture(mTextureId);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+			isMipmapped ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, mFormat, mWidth, mHeight, 0, mFormat, GL_UNSIGNED_BYTE, lImageBuffer);
+		//Rows are tightly packed, RGB and luminance rows of halved
+		//variants often aren't a multiple of the default 4 bytes
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if(levels.empty())
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, mFormat, width, height, 0, mFormat, GL_UNSIGNED_BYTE, lImageBuffer);
+			mMemorySize = width * height * GetComponentCount(mFormat);
+		}
+		for(uint32 i = 0; i < levels.size(); ++i)
+		{
+			const MipLevel & level = levels[i];
+			mMemorySize += level.size;
+			if(mImage.isCompressed)
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, mFormat, level.width, level.height,
+					0, level.size, lImageBuffer + level.offset);
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, i, mFormat, level.width, level.height,
+					0, mFormat, GL_UNSIGNED_BYTE, lImageBuffer + level.offset);
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 		delete[] lImageBuffer;
 
 #if defined(DEBUG) | defined(_DEBUG)
@@ -324,16 +1005,28 @@ namespace star
 				_T("PNG : Error loading png into OpenGl"), LIBPNG_LOG_TAG);
 			if(mTextureId != 0)
 			{
-				glDeleteTextures(1, &mTextureId);
+				GLStateCache::GetInstance()->DeleteTextures(1, &mTextureId);
 				mTextureId = 0;
 			}
 			mWidth = 0;
 			mHeight = 0;
 			mFormat = 0;
+			mMemorySize = 0;
+			mState = State::Failed;
 		}
 #endif
 	}
 
+	bool Texture2D::IsReady() const
+	{
+		return mState == State::Ready;
+	}
+
+	bool Texture2D::HasFailed() const
+	{
+		return mState == State::Failed;
+	}
+
 	const tstring & Texture2D::GetPath() const
 	{
 #ifdef DESKTOP
@@ -358,14 +1051,44 @@ namespace star
 		return mTextureId;
 	}
 
+	const vec4 & Texture2D::GetUVRegion() const
+	{
+		return mUVRegion;
+	}
+
+	bool Texture2D::IsAtlasTexture() const
+	{
+		return mIsAtlasTexture;
+	}
+
+	uint32 Texture2D::GetMemorySize() const
+	{
+		return mMemorySize;
+	}
+
+	float32 Texture2D::GetScale() const
+	{
+		return mScale;
+	}
+
+	//Decoding can happen on a worker thread and the Logger isn't thread safe,
+	//so libpng messages are kept in the ImageData and logged in Upload.
 	void Texture2D::CustomErrorFunction(png_structp pngPtr, png_const_charp error) 
 	{
-		DEBUG_LOG(LogLevel::Error, string_cast<tstring>(error), LIBPNG_LOG_TAG);
+		ImageData* image = reinterpret_cast<ImageData*>(png_get_error_ptr(pngPtr));
+		if(image != nullptr)
+		{
+			image->error = string_cast<tstring>(error);
+		}
 		setjmp(png_jmpbuf(pngPtr));
 	}
 
 	void Texture2D::CustomWarningFunction(png_structp pngPtr, png_const_charp warning) 
 	{
-		DEBUG_LOG(LogLevel::Warning, string_cast<tstring>(warning), LIBPNG_LOG_TAG);
+		ImageData* image = reinterpret_cast<ImageData*>(png_get_error_ptr(pngPtr));
+		if(image != nullptr && image->error.empty())
+		{
+			image->error = string_cast<tstring>(warning);
+		}
 	}
 }
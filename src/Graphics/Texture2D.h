@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "../defines.h"
 #include "../Logger.h"
 
@@ -21,27 +22,128 @@
 
 namespace star
 {
+	class TextureAtlas;
+
 	class Texture2D final
 	{
 	public:
 		//[NOTE]	You're not supposed to make Textures yourself.
 		//			Use the TextureManager to load your textures.
 		//			This ensures a same texture is not loaded multiple times
-		Texture2D(const tstring & pPath);
+		//			When an atlas is passed, the texture gets packed in
+		//			one of its pages if it's small enough.
+		//			Besides png, .ktx and .dds files with ETC1, ETC2 or S3TC
+		//			data are loaded, including their mip levels.
+		//			Those are never packed in the atlas.
+		Texture2D(const tstring & pPath, TextureAtlas* pAtlas = nullptr);
+		//[NOTE]	Deferred textures only read their size from the png header.
+		//			Decode can then run on a worker thread, after which
+		//			Upload has to be called on the thread owning the GL context.
+		//			With a scale of 0.5 or 0.25 a smaller variant gets uploaded,
+		//			read from 'name@0.5x.png' or 'name@0.25x.png' next to the file
+		//			when there is one, scaled down while decoding otherwise.
+		//			The width and height stay those of the original file.
+		Texture2D(
+			const tstring & pPath,
+			TextureAtlas* pAtlas,
+			bool deferLoading,
+			float32 scale = 1.0f
+			);
 		~Texture2D();
 
+		//Reads the image into memory, doesn't touch GL nor the logger
+		bool Decode();
+		//Creates the GL texture out of the decoded png and frees it
+		void Upload();
+		bool IsReady() const;
+		bool HasFailed() const;
+
 		const tstring & GetPath() const;
 		int32 GetHeight() const;
 		int32 GetWidth() const;
 		GLuint GetTextureID() const;
+		//Offset (xy) and size (zw) of this texture in uv space
+		const vec4 & GetUVRegion() const;
+		bool IsAtlasTexture() const;
+		//GPU memory of the texture and its mip levels, 0 when in the atlas
+		uint32 GetMemorySize() const;
+		//The scale it was loaded for, files that can't be
+		//scaled down any further are uploaded larger.
+		float32 GetScale() const;
 
 	private:
-		uint8* ReadPNG();
+		enum class State : byte
+		{
+			Pending,
+			Ready,
+			Failed
+		};
+
+		enum class FileType : byte
+		{
+			PNG,
+			KTX,
+			DDS
+		};
+
+		struct MipLevel
+		{
+			//Byte range in the pixels of the ImageData
+			uint32 offset, size;
+			int32 width, height;
+		};
+
+		//Result of a decode, kept apart from the texture's own fields
+		//because those can be read on the main thread while decoding.
+		struct ImageData
+		{
+			ImageData();
+
+			uint8* pixels;
+			GLint format;
+			int32 width, height;
+			//Size of the original file, what the texture reports as its size
+			int32 sourceWidth, sourceHeight;
+			//Only filled for ktx and dds files
+			std::vector<MipLevel> levels;
+			bool isCompressed;
+			tstring error;
+		};
+
+		FileType GetFileType() const;
+		bool ReadFile(const tstring & path, std::vector<uint8> & data, tstring & error) const;
+		bool ReadPNG(const tstring & path, ImageData & image);
+		bool ReadKTX(const tstring & path, ImageData & image);
+		bool ReadDDS(const tstring & path, ImageData & image);
+		//Copies the levels out of the file data, their offsets point in there
+		void StoreLevels(const std::vector<uint8> & data, ImageData & image) const;
+		//Falls back to RGBA8 when the context can't sample the format
+		bool PrepareCompressedImage(ImageData & image) const;
+		bool ReadImageHeader(const tstring & path, int32 & width, int32 & height) const;
+		//Drops mip levels or halves the pixels, once per step
+		void ScaleImage(ImageData & image, int32 steps) const;
 		void Load();
+		static uint32 ReadUInt32(const uint8* data);
+		//Header values are checked against GL_MAX_TEXTURE_SIZE
+		//before anything gets allocated for them
+		static bool IsValidImageSize(int32 width, int32 height, uint32 levelCount);
+		//Amount of times the image gets halved for a scale
+		static int32 GetScaleSteps(float32 scale);
+		static tstring GetVariantPath(const tstring & path, int32 steps);
+		//Box filter, odd sizes round up by repeating the last row or column
+		static uint8* HalveImage(const uint8* pixels, int32 width, int32 height, int32 components);
+		static int32 GetComponentCount(GLint format);
 		
 		GLuint	mTextureId;	
 		GLint	mFormat;
 		int32 mWidth, mHeight;
+		TextureAtlas* mAtlas;
+		vec4 mUVRegion;
+		bool mIsAtlasTexture;
+		uint32 mMemorySize;
+		float32 mScale;
+		State mState;
+		ImageData mImage;
 #ifdef ANDROID
 		Resource mResource;
 		static void CallbackRead(png_structp png, png_bytep data, png_size_t size);
@@ -0,0 +1,384 @@
+#include "TextureAtlas.h"
+#include "../Logger.h"
+#include "../Helpers/Helpers.h"
+#include "GLStateCache.h"
+#include <algorithm>
+
+namespace star
+{
+	TextureAtlas::TextureAtlas(int32 pageSize, int32 maxTextureSize)
+		: m_PageSize(pageSize)
+		, m_MaxTextureSize(maxTextureSize)
+		, m_Pages()
+	{
+
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		Clear();
+	}
+
+	bool TextureAtlas::Insert(
+		const uint8* pixels,
+		GLint format,
+		int32 width,
+		int32 height,
+		GLuint & textureID,
+		vec4 & uvRegion
+		)
+	{
+		if(pixels == nullptr || !CanContain(width, height))
+		{
+			return false;
+		}
+
+		int32 paddedWidth = width + 2 * PADDING;
+		int32 paddedHeight = height + 2 * PADDING;
+
+		ivec2 position;
+		uint32 nodeIndex(0);
+		uint32 pageIndex(0);
+		bool isReused(false);
+		for( ; pageIndex < m_Pages.size(); ++pageIndex)
+		{
+			if(TakeFreeRect(m_Pages[pageIndex], paddedWidth, paddedHeight, position))
+			{
+				isReused = true;
+				break;
+			}
+		}
+
+		if(!isReused)
+		{
+			for(pageIndex = 0; pageIndex < m_Pages.size(); ++pageIndex)
+			{
+				if(FindPosition(m_Pages[pageIndex], paddedWidth, paddedHeight, position, nodeIndex))
+				{
+					break;
+				}
+			}
+
+			if(pageIndex == m_Pages.size())
+			{
+				CreatePage();
+				if(!FindPosition(m_Pages[pageIndex], paddedWidth, paddedHeight, position, nodeIndex))
+				{
+					return false;
+				}
+			}
+		}
+
+		Page & page = m_Pages[pageIndex];
+		if(!isReused)
+		{
+			AddSkylineNode(page, nodeIndex, position, paddedWidth, paddedHeight);
+		}
+		++page.entryCount;
+
+		//Expand to RGBA and extrude the border pixels into the padding,
+		//this gives the same result as GL_CLAMP_TO_EDGE on a single texture
+		std::vector<uint8> rgba;
+		ConvertToRGBA(pixels, format, width, height, rgba);
+
+		std::vector<uint8> padded(paddedWidth * paddedHeight * 4);
+		for(int32 y = 0; y < paddedHeight; ++y)
+		{
+			int32 srcY = std::max(0, std::min(y - PADDING, height - 1));
+			for(int32 x = 0; x < paddedWidth; ++x)
+			{
+				int32 srcX = std::max(0, std::min(x - PADDING, width - 1));
+				const uint8* src = &rgba[(srcX + srcY * width) * 4];
+				uint8* dst = &padded[(x + y * paddedWidth) * 4];
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = src[3];
+			}
+		}
+
+		GLStateCache::GetInstance()->BindTexture(page.textureID);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y,
+			paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, &padded[0]);
+		OPENGL_LOG();
+
+		float32 pageSize = float32(m_PageSize);
+		textureID = page.textureID;
+		uvRegion = vec4(
+			float32(position.x + PADDING) / pageSize,
+			float32(position.y + PADDING) / pageSize,
+			float32(width) / pageSize,
+			float32(height) / pageSize
+			);
+		return true;
+	}
+
+	void TextureAtlas::Release(GLuint textureID, const vec4 & uvRegion)
+	{
+		for(auto it = m_Pages.begin(); it != m_Pages.end(); ++it)
+		{
+			if(it->textureID != textureID)
+			{
+				continue;
+			}
+
+			if(it->entryCount <= 1)
+			{
+				GLStateCache::GetInstance()->DeleteTextures(1, &it->textureID);
+				m_Pages.erase(it);
+				DEBUG_LOG(LogLevel::Info,
+					_T("TextureAtlas::Release: Deleted an empty atlas page"),
+					STARENGINE_LOG_TAG);
+				return;
+			}
+			--it->entryCount;
+
+			//Same rounding Insert did the other way around, page sizes are powers of two
+			float32 pageSize = float32(m_PageSize);
+			it->freeRects.push_back(PageRect(
+				int32(uvRegion.x * pageSize + 0.5f) - PADDING,
+				int32(uvRegion.y * pageSize + 0.5f) - PADDING,
+				int32(uvRegion.z * pageSize + 0.5f) + 2 * PADDING,
+				int32(uvRegion.w * pageSize + 0.5f) + 2 * PADDING
+				));
+			return;
+		}
+	}
+
+	void TextureAtlas::Clear()
+	{
+		for(Page & page : m_Pages)
+		{
+			if(page.textureID != 0)
+			{
+				GLStateCache::GetInstance()->DeleteTextures(1, &page.textureID);
+				page.textureID = 0;
+			}
+		}
+		m_Pages.clear();
+	}
+
+	bool TextureAtlas::CanContain(int32 width, int32 height) const
+	{
+		return width > 0 && height > 0
+			&& width <= m_MaxTextureSize && height <= m_MaxTextureSize
+			&& width + 2 * PADDING <= m_PageSize
+			&& height + 2 * PADDING <= m_PageSize;
+	}
+
+	int32 TextureAtlas::GetPageSize() const
+	{
+		return m_PageSize;
+	}
+
+	int32 TextureAtlas::GetMaxTextureSize() const
+	{
+		return m_MaxTextureSize;
+	}
+
+	uint32 TextureAtlas::GetPageCount() const
+	{
+		return m_Pages.size();
+	}
+
+	void TextureAtlas::CreatePage()
+	{
+		Page page;
+		page.skyline.push_back(SkylineNode(0, 0, m_PageSize));
+
+		glGenTextures(1, &page.textureID);
+		GLStateCache::GetInstance()->BindTexture(page.textureID);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_PageSize, m_PageSize,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		OPENGL_LOG();
+
+		DEBUG_LOG(LogLevel::Info,
+			_T("TextureAtlas::CreatePage: Created atlas page ") +
+			string_cast<tstring>(m_Pages.size()), STARENGINE_LOG_TAG);
+
+		m_Pages.push_back(page);
+	}
+
+	bool TextureAtlas::TakeFreeRect(Page & page, int32 width, int32 height,
+		ivec2 & position) const
+	{
+		//Smallest released region the texture fits in
+		int32 best(-1), bestArea(0);
+		for(uint32 i = 0; i < page.freeRects.size(); ++i)
+		{
+			const PageRect & rect = page.freeRects[i];
+			int32 area = rect.width * rect.height;
+			if(rect.width >= width && rect.height >= height
+				&& (best < 0 || area < bestArea))
+			{
+				best = int32(i);
+				bestArea = area;
+			}
+		}
+		if(best < 0)
+		{
+			return false;
+		}
+
+		PageRect rect = page.freeRects[best];
+		page.freeRects.erase(page.freeRects.begin() + best);
+		position = ivec2(rect.x, rect.y);
+
+		//Keep what's left right of and above the texture
+		if(rect.width > width)
+		{
+			page.freeRects.push_back(PageRect(rect.x + width, rect.y,
+				rect.width - width, height));
+		}
+		if(rect.height > height)
+		{
+			page.freeRects.push_back(PageRect(rect.x, rect.y + height,
+				rect.width, rect.height - height));
+		}
+		return true;
+	}
+
+	bool TextureAtlas::FindPosition(const Page & page, int32 width, int32 height,
+		ivec2 & position, uint32 & nodeIndex) const
+	{
+		//Bottom-left skyline heuristic:
+		//take the lowest position, the narrowest segment on a tie.
+		int32 bestTop(m_PageSize + 1),
+			  bestWidth(m_PageSize + 1);
+		bool found(false);
+		for(uint32 i = 0; i < page.skyline.size(); ++i)
+		{
+			int32 y;
+			if(FitsOnNode(page, i, width, height, y))
+			{
+				const SkylineNode & node = page.skyline[i];
+				if(y + height < bestTop
+					|| (y + height == bestTop && node.width < bestWidth))
+				{
+					bestTop = y + height;
+					bestWidth = node.width;
+					position = ivec2(node.x, y);
+					nodeIndex = i;
+					found = true;
+				}
+			}
+		}
+		return found;
+	}
+
+	bool TextureAtlas::FitsOnNode(const Page & page, uint32 nodeIndex,
+		int32 width, int32 height, int32 & y) const
+	{
+		int32 x = page.skyline[nodeIndex].x;
+		if(x + width > m_PageSize)
+		{
+			return false;
+		}
+
+		int32 widthLeft = width;
+		y = page.skyline[nodeIndex].y;
+		while(widthLeft > 0)
+		{
+			if(nodeIndex >= page.skyline.size())
+			{
+				return false;
+			}
+			const SkylineNode & node = page.skyline[nodeIndex];
+			if(node.y > y)
+			{
+				y = node.y;
+			}
+			if(y + height > m_PageSize)
+			{
+				return false;
+			}
+			widthLeft -= node.width;
+			++nodeIndex;
+		}
+		return true;
+	}
+
+	void TextureAtlas::AddSkylineNode(Page & page, uint32 nodeIndex,
+		const ivec2 & position, int32 width, int32 height)
+	{
+		std::vector<SkylineNode> & skyline = page.skyline;
+		skyline.insert(skyline.begin() + nodeIndex,
+			SkylineNode(position.x, position.y + height, width));
+
+		//Shrink or remove the nodes that are now covered by the new one
+		for(uint32 i = nodeIndex + 1; i < skyline.size(); )
+		{
+			const SkylineNode & previous = skyline[i - 1];
+			int32 previousEnd = previous.x + previous.width;
+			if(skyline[i].x >= previousEnd)
+			{
+				break;
+			}
+			int32 shrink = previousEnd - skyline[i].x;
+			skyline[i].x += shrink;
+			skyline[i].width -= shrink;
+			if(skyline[i].width > 0)
+			{
+				break;
+			}
+			skyline.erase(skyline.begin() + i);
+		}
+
+		//Merge neighbours at the same height
+		for(uint32 i = 0; i + 1 < skyline.size(); )
+		{
+			if(skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	void TextureAtlas::ConvertToRGBA(const uint8* pixels, GLint format,
+		int32 width, int32 height, std::vector<uint8> & out) const
+	{
+		uint32 amount = uint32(width * height);
+		out.resize(amount * 4);
+		for(uint32 i = 0; i < amount; ++i)
+		{
+			uint8* dst = &out[i * 4];
+			switch(format)
+			{
+			case GL_RGBA:
+				dst[0] = pixels[i * 4];
+				dst[1] = pixels[i * 4 + 1];
+				dst[2] = pixels[i * 4 + 2];
+				dst[3] = pixels[i * 4 + 3];
+				break;
+			case GL_RGB:
+				dst[0] = pixels[i * 3];
+				dst[1] = pixels[i * 3 + 1];
+				dst[2] = pixels[i * 3 + 2];
+				dst[3] = 255;
+				break;
+			case GL_LUMINANCE_ALPHA:
+				dst[0] = dst[1] = dst[2] = pixels[i * 2];
+				dst[3] = pixels[i * 2 + 1];
+				break;
+			case GL_LUMINANCE:
+				dst[0] = dst[1] = dst[2] = pixels[i];
+				dst[3] = 255;
+				break;
+			default:
+				dst[0] = dst[1] = dst[2] = dst[3] = 255;
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include "../defines.h"
+
+#ifdef DESKTOP
+#include <glew.h>
+#else
+#include <GLES/gl.h>
+#endif
+
+namespace star
+{
+	//[NOTE]	The TextureAtlas is owned by the TextureManager.
+	//			Small textures get packed in shared RGBA pages,
+	//			so the SpriteBatch doesn't have to break its batch for them.
+	class TextureAtlas final
+	{
+	public:
+		TextureAtlas(int32 pageSize, int32 maxTextureSize);
+		~TextureAtlas();
+
+		bool Insert(
+			const uint8* pixels,
+			GLint format,
+			int32 width,
+			int32 height,
+			GLuint & textureID,
+			vec4 & uvRegion
+			);
+		//Gives the region back, a page is deleted with its last texture
+		void Release(GLuint textureID, const vec4 & uvRegion);
+		void Clear();
+
+		bool CanContain(int32 width, int32 height) const;
+		int32 GetPageSize() const;
+		int32 GetMaxTextureSize() const;
+		uint32 GetPageCount() const;
+
+	private:
+		//One segment of the skyline, from x to x + width at height y
+		struct SkylineNode
+		{
+			SkylineNode(int32 X, int32 Y, int32 Width)
+				: x(X)
+				, y(Y)
+				, width(Width)
+			{
+
+			}
+
+			int32 x, y, width;
+		};
+
+		//Padded region of a released texture
+		struct PageRect
+		{
+			PageRect(int32 X, int32 Y, int32 Width, int32 Height)
+				: x(X)
+				, y(Y)
+				, width(Width)
+				, height(Height)
+			{
+
+			}
+
+			int32 x, y, width, height;
+		};
+
+		struct Page
+		{
+			Page()
+				: textureID(0)
+				, entryCount(0)
+				, skyline()
+				, freeRects()
+			{
+
+			}
+
+			GLuint textureID;
+			uint32 entryCount;
+			std::vector<SkylineNode> skyline;
+			//The skyline can't grow back down, released regions are reused from here
+			std::vector<PageRect> freeRects;
+		};
+
+		void CreatePage();
+		bool TakeFreeRect(Page & page, int32 width, int32 height,
+			ivec2 & position) const;
+		bool FindPosition(const Page & page, int32 width, int32 height,
+			ivec2 & position, uint32 & nodeIndex) const;
+		bool FitsOnNode(const Page & page, uint32 nodeIndex,
+			int32 width, int32 height, int32 & y) const;
+		void AddSkylineNode(Page & page, uint32 nodeIndex,
+			const ivec2 & position, int32 width, int32 height);
+		void ConvertToRGBA(const uint8* pixels, GLint format,
+			int32 width, int32 height, std::vector<uint8> & out) const;
+
+		static const int32 PADDING = 1;
+
+		int32 m_PageSize,
+			  m_MaxTextureSize;
+		std::vector<Page> m_Pages;
+
+		TextureAtlas(const TextureAtlas& yRef);
+		TextureAtlas(TextureAtlas&& yRef);
+		TextureAtlas& operator=(const TextureAtlas& yRef);
+		TextureAtlas& operator=(TextureAtlas&& yRef);
+	};
+}
@@ -0,0 +1,611 @@
+#include "TextureCompression.h"
+#include <algorithm>
+#include <string.h>
+
+namespace star
+{
+	const int32 TextureCompression::ETC_MODIFIERS[8][4] =
+	{
+		{ 2, 8, -2, -8 },
+		{ 5, 17, -5, -17 },
+		{ 9, 29, -9, -29 },
+		{ 13, 42, -13, -42 },
+		{ 18, 60, -18, -60 },
+		{ 24, 80, -24, -80 },
+		{ 33, 106, -33, -106 },
+		{ 47, 183, -47, -183 }
+	};
+
+	const int32 TextureCompression::ETC2_DISTANCES[8] =
+	{
+		3, 6, 11, 16, 23, 32, 41, 64
+	};
+
+	const int32 TextureCompression::EAC_MODIFIERS[16][8] =
+	{
+		{ -3, -6, -9, -15, 2, 5, 8, 14 },
+		{ -3, -7, -10, -13, 2, 6, 9, 12 },
+		{ -2, -5, -8, -13, 1, 4, 7, 12 },
+		{ -2, -4, -6, -13, 1, 3, 5, 12 },
+		{ -3, -6, -8, -12, 2, 5, 7, 11 },
+		{ -3, -7, -9, -11, 2, 6, 8, 10 },
+		{ -4, -7, -8, -11, 3, 6, 7, 10 },
+		{ -3, -5, -8, -11, 2, 4, 7, 10 },
+		{ -2, -6, -8, -10, 1, 5, 7, 9 },
+		{ -2, -5, -8, -10, 1, 4, 7, 9 },
+		{ -2, -4, -8, -10, 1, 3, 7, 9 },
+		{ -2, -5, -7, -10, 1, 4, 6, 9 },
+		{ -3, -4, -7, -10, 2, 3, 6, 9 },
+		{ -1, -2, -3, -10, 0, 1, 2, 9 },
+		{ -4, -6, -8, -9, 3, 5, 7, 8 },
+		{ -3, -5, -7, -9, 2, 4, 6, 8 }
+	};
+
+	bool TextureCompression::IsSupportedFormat(GLenum format)
+	{
+		return IsETCFormat(format) || IsS3TCFormat(format);
+	}
+
+	bool TextureCompression::IsETCFormat(GLenum format)
+	{
+		switch(format)
+		{
+		case GL_ETC1_RGB8_OES:
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	bool TextureCompression::IsS3TCFormat(GLenum format)
+	{
+		switch(format)
+		{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	uint32 TextureCompression::GetBlockBytes(GLenum format)
+	{
+		switch(format)
+		{
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return 16;
+		default:
+			return 8;
+		}
+	}
+
+	uint64 TextureCompression::GetImageSize(GLenum format, int32 width, int32 height)
+	{
+		uint64 blocksX = (uint64(std::max(width, 1)) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		uint64 blocksY = (uint64(std::max(height, 1)) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		return blocksX * blocksY * GetBlockBytes(format);
+	}
+
+	bool TextureCompression::Decompress(
+		GLenum format,
+		const uint8* data,
+		int32 width,
+		int32 height,
+		uint8* pixels
+		)
+	{
+		if(!IsSupportedFormat(format))
+		{
+			return false;
+		}
+
+		uint32 blockBytes = GetBlockBytes(format);
+		int32 blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		int32 blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		uint8 block[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+		for(int32 by = 0; by < blocksY; ++by)
+		{
+			for(int32 bx = 0; bx < blocksX; ++bx)
+			{
+				const uint8* source = data + (by * blocksX + bx) * blockBytes;
+				switch(format)
+				{
+				case GL_ETC1_RGB8_OES:
+					DecodeETC1Block(source, block);
+					break;
+				case GL_COMPRESSED_RGB8_ETC2:
+					DecodeETC2Block(source, block, false);
+					break;
+				case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+					DecodeETC2Block(source, block, true);
+					break;
+				case GL_COMPRESSED_RGBA8_ETC2_EAC:
+					DecodeETC2Block(source + 8, block, false);
+					DecodeEACAlphaBlock(source, block);
+					break;
+				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+					DecodeDXTColorBlock(source, block, true, false);
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+					DecodeDXTColorBlock(source, block, true, true);
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+					DecodeDXTColorBlock(source + 8, block, false, true);
+					DecodeDXT3AlphaBlock(source, block);
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+					DecodeDXTColorBlock(source + 8, block, false, true);
+					DecodeDXT5AlphaBlock(source, block);
+					break;
+				}
+
+				//Blocks at the right and bottom edge can be partially outside
+				int32 columns = std::min(int32(BLOCK_SIZE), width - bx * BLOCK_SIZE);
+				int32 rows = std::min(int32(BLOCK_SIZE), height - by * BLOCK_SIZE);
+				for(int32 y = 0; y < rows; ++y)
+				{
+					memcpy(
+						pixels + ((by * BLOCK_SIZE + y) * width + bx * BLOCK_SIZE) * 4,
+						block + y * BLOCK_SIZE * 4,
+						columns * 4
+						);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool TextureCompression::FlipS3TCImage(GLenum format, uint8* data, int32 width, int32 height)
+	{
+		if(!IsS3TCFormat(format) || (height > BLOCK_SIZE && height % BLOCK_SIZE != 0))
+		{
+			return false;
+		}
+
+		uint32 blockBytes = GetBlockBytes(format);
+		int32 blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		int32 blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		int32 rows = std::min(height, int32(BLOCK_SIZE));
+		uint32 rowBytes = blocksX * blockBytes;
+
+		//Swap the block rows, then flip the rows inside every block
+		for(int32 by = 0; by < blocksY / 2; ++by)
+		{
+			std::swap_ranges(
+				data + by * rowBytes,
+				data + (by + 1) * rowBytes,
+				data + (blocksY - by - 1) * rowBytes
+				);
+		}
+
+		for(int32 i = 0; i < blocksX * blocksY; ++i)
+		{
+			uint8* block = data + i * blockBytes;
+			switch(format)
+			{
+			case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+				FlipDXT3AlphaBlock(block, rows);
+				FlipDXTColorBlock(block + 8, rows);
+				break;
+			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+				FlipDXT5AlphaBlock(block, rows);
+				FlipDXTColorBlock(block + 8, rows);
+				break;
+			default:
+				FlipDXTColorBlock(block, rows);
+				break;
+			}
+		}
+		return true;
+	}
+
+	void TextureCompression::DecodeETC1Block(const uint8* block, uint8* rgba)
+	{
+		uint64 bits = ReadBigEndian64(block);
+		int32 r1, g1, b1, r2, g2, b2;
+		if(GetBits(bits, 33, 1) != 0)
+		{
+			//Differential mode, 5 bit base color and a 3 bit signed offset
+			r1 = GetBits(bits, 63, 5);
+			g1 = GetBits(bits, 55, 5);
+			b1 = GetBits(bits, 47, 5);
+			r2 = r1 + SignExtend3(GetBits(bits, 58, 3));
+			g2 = g1 + SignExtend3(GetBits(bits, 50, 3));
+			b2 = b1 + SignExtend3(GetBits(bits, 42, 3));
+			r1 = Extend5(r1);
+			g1 = Extend5(g1);
+			b1 = Extend5(b1);
+			r2 = Extend5(r2 & 0x1F);
+			g2 = Extend5(g2 & 0x1F);
+			b2 = Extend5(b2 & 0x1F);
+		}
+		else
+		{
+			//Individual mode, two 4 bit colors
+			r1 = Extend4(GetBits(bits, 63, 4));
+			r2 = Extend4(GetBits(bits, 59, 4));
+			g1 = Extend4(GetBits(bits, 55, 4));
+			g2 = Extend4(GetBits(bits, 51, 4));
+			b1 = Extend4(GetBits(bits, 47, 4));
+			b2 = Extend4(GetBits(bits, 43, 4));
+		}
+		DecodeETCSubBlocks(bits, r1, g1, b1, r2, g2, b2, false, rgba);
+	}
+
+	void TextureCompression::DecodeETC2Block(const uint8* block, uint8* rgba, bool punchThrough)
+	{
+		uint64 bits = ReadBigEndian64(block);
+		//The punch through format replaces the diff bit with an opaque bit
+		//and only has the differential based modes.
+		bool isOpaque = !punchThrough || GetBits(bits, 33, 1) != 0;
+		if(!punchThrough && GetBits(bits, 33, 1) == 0)
+		{
+			DecodeETC1Block(block, rgba);
+			return;
+		}
+
+		int32 r = GetBits(bits, 63, 5) + SignExtend3(GetBits(bits, 58, 3));
+		int32 g = GetBits(bits, 55, 5) + SignExtend3(GetBits(bits, 50, 3));
+		int32 b = GetBits(bits, 47, 5) + SignExtend3(GetBits(bits, 42, 3));
+
+		if(r < 0 || r > 31)
+		{
+			//T mode
+			int32 paint[4][3];
+			paint[0][0] = Extend4((GetBits(bits, 60, 2) << 2) | GetBits(bits, 57, 2));
+			paint[0][1] = Extend4(GetBits(bits, 55, 4));
+			paint[0][2] = Extend4(GetBits(bits, 51, 4));
+			int32 r2 = Extend4(GetBits(bits, 47, 4));
+			int32 g2 = Extend4(GetBits(bits, 43, 4));
+			int32 b2 = Extend4(GetBits(bits, 39, 4));
+			int32 distance = ETC2_DISTANCES[(GetBits(bits, 35, 2) << 1) | GetBits(bits, 32, 1)];
+			for(int32 i = 1; i < 4; ++i)
+			{
+				int32 offset = i == 1 ? distance : (i == 3 ? -distance : 0);
+				paint[i][0] = Clamp(r2 + offset);
+				paint[i][1] = Clamp(g2 + offset);
+				paint[i][2] = Clamp(b2 + offset);
+			}
+			DecodeETCPaintColors(bits, paint, isOpaque, rgba);
+		}
+		else if(g < 0 || g > 31)
+		{
+			//H mode
+			int32 r1 = GetBits(bits, 62, 4);
+			int32 g1 = (GetBits(bits, 58, 3) << 1) | GetBits(bits, 52, 1);
+			int32 b1 = (GetBits(bits, 51, 1) << 3) | GetBits(bits, 49, 3);
+			int32 r2 = GetBits(bits, 46, 4);
+			int32 g2 = GetBits(bits, 42, 4);
+			int32 b2 = GetBits(bits, 38, 4);
+			int32 index = (GetBits(bits, 34, 1) << 2) | (GetBits(bits, 32, 1) << 1);
+			if(((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2))
+			{
+				index |= 1;
+			}
+			int32 distance = ETC2_DISTANCES[index];
+
+			int32 paint[4][3];
+			for(int32 i = 0; i < 4; ++i)
+			{
+				int32 offset = (i % 2 == 0) ? distance : -distance;
+				paint[i][0] = Clamp(Extend4(i < 2 ? r1 : r2) + offset);
+				paint[i][1] = Clamp(Extend4(i < 2 ? g1 : g2) + offset);
+				paint[i][2] = Clamp(Extend4(i < 2 ? b1 : b2) + offset);
+			}
+			DecodeETCPaintColors(bits, paint, isOpaque, rgba);
+		}
+		else if(b < 0 || b > 31)
+		{
+			//Planar mode, always opaque
+			int32 ro = Extend6(GetBits(bits, 62, 6));
+			int32 go = Extend7((GetBits(bits, 56, 1) << 6) | GetBits(bits, 54, 6));
+			int32 bo = Extend6((GetBits(bits, 48, 1) << 5)
+				| (GetBits(bits, 44, 2) << 3) | GetBits(bits, 41, 3));
+			int32 rh = Extend6((GetBits(bits, 38, 5) << 1) | GetBits(bits, 32, 1));
+			int32 gh = Extend7(GetBits(bits, 31, 7));
+			int32 bh = Extend6(GetBits(bits, 24, 6));
+			int32 rv = Extend6(GetBits(bits, 18, 6));
+			int32 gv = Extend7(GetBits(bits, 12, 7));
+			int32 bv = Extend6(GetBits(bits, 5, 6));
+
+			for(int32 y = 0; y < BLOCK_SIZE; ++y)
+			{
+				for(int32 x = 0; x < BLOCK_SIZE; ++x)
+				{
+					uint8* pixel = rgba + (y * BLOCK_SIZE + x) * 4;
+					pixel[0] = Clamp((x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2);
+					pixel[1] = Clamp((x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2);
+					pixel[2] = Clamp((x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2);
+					pixel[3] = 255;
+				}
+			}
+		}
+		else
+		{
+			DecodeETCSubBlocks(bits,
+				Extend5(GetBits(bits, 63, 5)),
+				Extend5(GetBits(bits, 55, 5)),
+				Extend5(GetBits(bits, 47, 5)),
+				Extend5(r), Extend5(g), Extend5(b),
+				!isOpaque, rgba);
+		}
+	}
+
+	void TextureCompression::DecodeETCSubBlocks(
+		uint64 bits,
+		int32 r1, int32 g1, int32 b1,
+		int32 r2, int32 g2, int32 b2,
+		bool punchThrough,
+		uint8* rgba
+		)
+	{
+		const int32* table1 = ETC_MODIFIERS[GetBits(bits, 39, 3)];
+		const int32* table2 = ETC_MODIFIERS[GetBits(bits, 36, 3)];
+		bool isFlipped = GetBits(bits, 32, 1) != 0;
+
+		for(int32 y = 0; y < BLOCK_SIZE; ++y)
+		{
+			for(int32 x = 0; x < BLOCK_SIZE; ++x)
+			{
+				//Side by side 2x4 sub blocks, or stacked 4x2 ones when flipped
+				bool isFirst = isFlipped ? y < 2 : x < 2;
+				int32 index = GetETCPixelIndex(bits, x, y);
+				uint8* pixel = rgba + (y * BLOCK_SIZE + x) * 4;
+
+				if(punchThrough && index == 2)
+				{
+					pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+					continue;
+				}
+
+				//Without the opaque bit, the smallest modifier is zero
+				int32 modifier = (punchThrough && index == 0) ? 0
+					: (isFirst ? table1[index] : table2[index]);
+				pixel[0] = Clamp((isFirst ? r1 : r2) + modifier);
+				pixel[1] = Clamp((isFirst ? g1 : g2) + modifier);
+				pixel[2] = Clamp((isFirst ? b1 : b2) + modifier);
+				pixel[3] = 255;
+			}
+		}
+	}
+
+	void TextureCompression::DecodeETCPaintColors(
+		uint64 bits,
+		const int32 paint[4][3],
+		bool isOpaque,
+		uint8* rgba
+		)
+	{
+		for(int32 y = 0; y < BLOCK_SIZE; ++y)
+		{
+			for(int32 x = 0; x < BLOCK_SIZE; ++x)
+			{
+				int32 index = GetETCPixelIndex(bits, x, y);
+				uint8* pixel = rgba + (y * BLOCK_SIZE + x) * 4;
+				if(!isOpaque && index == 2)
+				{
+					pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
+					continue;
+				}
+				pixel[0] = uint8(paint[index][0]);
+				pixel[1] = uint8(paint[index][1]);
+				pixel[2] = uint8(paint[index][2]);
+				pixel[3] = 255;
+			}
+		}
+	}
+
+	void TextureCompression::DecodeEACAlphaBlock(const uint8* block, uint8* rgba)
+	{
+		uint64 bits = ReadBigEndian64(block);
+		int32 base = GetBits(bits, 63, 8);
+		int32 multiplier = GetBits(bits, 55, 4);
+		const int32* table = EAC_MODIFIERS[GetBits(bits, 51, 4)];
+
+		for(int32 y = 0; y < BLOCK_SIZE; ++y)
+		{
+			for(int32 x = 0; x < BLOCK_SIZE; ++x)
+			{
+				//3 bit indices, column major starting at bit 47
+				int32 index = GetBits(bits, 47 - (x * BLOCK_SIZE + y) * 3, 3);
+				rgba[(y * BLOCK_SIZE + x) * 4 + 3] = Clamp(base + table[index] * multiplier);
+			}
+		}
+	}
+
+	void TextureCompression::DecodeDXTColorBlock(
+		const uint8* block,
+		uint8* rgba,
+		bool isDXT1,
+		bool hasAlpha
+		)
+	{
+		uint32 c0 = block[0] | (block[1] << 8);
+		uint32 c1 = block[2] | (block[3] << 8);
+		uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (block[7] << 24);
+
+		int32 colors[4][4];
+		UnpackRGB565(c0, colors[0]);
+		UnpackRGB565(c1, colors[1]);
+		//DXT3 and DXT5 always use the 4 color mode
+		if(c0 > c1 || !isDXT1)
+		{
+			for(int32 i = 0; i < 3; ++i)
+			{
+				colors[2][i] = (2 * colors[0][i] + colors[1][i]) / 3;
+				colors[3][i] = (colors[0][i] + 2 * colors[1][i]) / 3;
+			}
+			colors[2][3] = colors[3][3] = 255;
+		}
+		else
+		{
+			for(int32 i = 0; i < 3; ++i)
+			{
+				colors[2][i] = (colors[0][i] + colors[1][i]) / 2;
+				colors[3][i] = 0;
+			}
+			colors[2][3] = 255;
+			colors[3][3] = hasAlpha ? 0 : 255;
+		}
+
+		for(int32 i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i)
+		{
+			const int32* color = colors[(indices >> (i * 2)) & 0x3];
+			rgba[i * 4] = uint8(color[0]);
+			rgba[i * 4 + 1] = uint8(color[1]);
+			rgba[i * 4 + 2] = uint8(color[2]);
+			rgba[i * 4 + 3] = uint8(color[3]);
+		}
+	}
+
+	void TextureCompression::DecodeDXT3AlphaBlock(const uint8* block, uint8* rgba)
+	{
+		for(int32 i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i)
+		{
+			int32 alpha = (block[i / 2] >> ((i % 2) * 4)) & 0xF;
+			rgba[i * 4 + 3] = uint8(Extend4(alpha));
+		}
+	}
+
+	void TextureCompression::DecodeDXT5AlphaBlock(const uint8* block, uint8* rgba)
+	{
+		int32 alphas[8];
+		alphas[0] = block[0];
+		alphas[1] = block[1];
+		if(alphas[0] > alphas[1])
+		{
+			for(int32 i = 1; i < 7; ++i)
+			{
+				alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+			}
+		}
+		else
+		{
+			for(int32 i = 1; i < 5; ++i)
+			{
+				alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+			}
+			alphas[6] = 0;
+			alphas[7] = 255;
+		}
+
+		uint64 indices = ReadLittleEndian48(block + 2);
+		for(int32 i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i)
+		{
+			rgba[i * 4 + 3] = uint8(alphas[(indices >> (i * 3)) & 0x7]);
+		}
+	}
+
+	void TextureCompression::FlipDXTColorBlock(uint8* block, int32 rows)
+	{
+		//One byte of indices per row
+		std::reverse(block + 4, block + 4 + rows);
+	}
+
+	void TextureCompression::FlipDXT3AlphaBlock(uint8* block, int32 rows)
+	{
+		//Two bytes of alpha per row
+		for(int32 y = 0; y < rows / 2; ++y)
+		{
+			std::swap(block[y * 2], block[(rows - y - 1) * 2]);
+			std::swap(block[y * 2 + 1], block[(rows - y - 1) * 2 + 1]);
+		}
+	}
+
+	void TextureCompression::FlipDXT5AlphaBlock(uint8* block, int32 rows)
+	{
+		//12 bits of indices per row
+		uint64 indices = ReadLittleEndian48(block + 2);
+		uint64 flipped = indices;
+		for(int32 y = 0; y < rows; ++y)
+		{
+			uint64 row = (indices >> (y * 12)) & 0xFFF;
+			int32 shift = (rows - y - 1) * 12;
+			flipped &= ~(uint64(0xFFF) << shift);
+			flipped |= row << shift;
+		}
+		for(int32 i = 0; i < 6; ++i)
+		{
+			block[2 + i] = uint8(flipped >> (i * 8));
+		}
+	}
+
+	int32 TextureCompression::GetETCPixelIndex(uint64 bits, int32 x, int32 y)
+	{
+		//Column major, the msb and lsb of every index are stored apart
+		int32 bit = x * BLOCK_SIZE + y;
+		return (GetBits(bits, 16 + bit, 1) << 1) | GetBits(bits, bit, 1);
+	}
+
+	int32 TextureCompression::GetBits(uint64 bits, int32 highBit, int32 count)
+	{
+		return int32(uint32(bits >> (highBit - count + 1)) & ((1u << count) - 1));
+	}
+
+	uint64 TextureCompression::ReadBigEndian64(const uint8* data)
+	{
+		uint64 value(0);
+		for(int32 i = 0; i < 8; ++i)
+		{
+			value = (value << 8) | data[i];
+		}
+		return value;
+	}
+
+	uint64 TextureCompression::ReadLittleEndian48(const uint8* data)
+	{
+		uint64 value(0);
+		for(int32 i = 5; i >= 0; --i)
+		{
+			value = (value << 8) | data[i];
+		}
+		return value;
+	}
+
+	void TextureCompression::UnpackRGB565(uint32 color, int32* rgb)
+	{
+		rgb[0] = Extend5((color >> 11) & 0x1F);
+		rgb[1] = Extend6((color >> 5) & 0x3F);
+		rgb[2] = Extend5(color & 0x1F);
+		rgb[3] = 255;
+	}
+
+	int32 TextureCompression::SignExtend3(int32 value)
+	{
+		return value >= 4 ? value - 8 : value;
+	}
+
+	int32 TextureCompression::Extend4(int32 value)
+	{
+		return (value << 4) | value;
+	}
+
+	int32 TextureCompression::Extend5(int32 value)
+	{
+		return (value << 3) | (value >> 2);
+	}
+
+	int32 TextureCompression::Extend6(int32 value)
+	{
+		return (value << 2) | (value >> 4);
+	}
+
+	int32 TextureCompression::Extend7(int32 value)
+	{
+		return (value << 1) | (value >> 6);
+	}
+
+	uint8 TextureCompression::Clamp(int32 value)
+	{
+		return uint8(std::min(std::max(value, 0), 255));
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../defines.h"
+
+#ifdef DESKTOP
+#include <glew.h>
+#else
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#endif
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace star
+{
+	//[NOTE]	Block compressed formats Texture2D can read from KTX and DDS files.
+	//			When the context can't sample a format, the data is decompressed
+	//			to RGBA8 on the cpu with the software decoders in here.
+	//			All formats use 4x4 blocks, stored left to right and top to bottom.
+	class TextureCompression final
+	{
+	public:
+		static const int32 BLOCK_SIZE = 4;
+
+		static bool IsSupportedFormat(GLenum format);
+		static bool IsETCFormat(GLenum format);
+		static bool IsS3TCFormat(GLenum format);
+		//8 or 16 bytes
+		static uint32 GetBlockBytes(GLenum format);
+		//64 bit, the size can come from an untrusted file header
+		static uint64 GetImageSize(GLenum format, int32 width, int32 height);
+
+		//Writes width * height RGBA8 pixels, rows in the same order as the blocks
+		static bool Decompress(
+			GLenum format,
+			const uint8* data,
+			int32 width,
+			int32 height,
+			uint8* pixels
+			);
+
+		//Reverses the rows of an S3TC image, DDS files are stored top down.
+		//Only exact when the height is a multiple of 4 or smaller than 4.
+		static bool FlipS3TCImage(GLenum format, uint8* data, int32 width, int32 height);
+
+	private:
+		static const int32 ETC_MODIFIERS[8][4];
+		static const int32 ETC2_DISTANCES[8];
+		static const int32 EAC_MODIFIERS[16][8];
+
+		//Decoded blocks are 4x4 RGBA8, row major
+		static void DecodeETC1Block(const uint8* block, uint8* rgba);
+		static void DecodeETC2Block(const uint8* block, uint8* rgba, bool punchThrough);
+		static void DecodeETCSubBlocks(
+			uint64 bits,
+			int32 r1, int32 g1, int32 b1,
+			int32 r2, int32 g2, int32 b2,
+			bool punchThrough,
+			uint8* rgba
+			);
+		static void DecodeETCPaintColors(
+			uint64 bits,
+			const int32 paint[4][3],
+			bool isOpaque,
+			uint8* rgba
+			);
+		static void DecodeEACAlphaBlock(const uint8* block, uint8* rgba);
+		static void DecodeDXTColorBlock(const uint8* block, uint8* rgba, bool isDXT1, bool hasAlpha);
+		static void DecodeDXT3AlphaBlock(const uint8* block, uint8* rgba);
+		static void DecodeDXT5AlphaBlock(const uint8* block, uint8* rgba);
+
+		static void FlipDXTColorBlock(uint8* block, int32 rows);
+		static void FlipDXT3AlphaBlock(uint8* block, int32 rows);
+		static void FlipDXT5AlphaBlock(uint8* block, int32 rows);
+
+		static int32 GetETCPixelIndex(uint64 bits, int32 x, int32 y);
+		static int32 GetBits(uint64 bits, int32 highBit, int32 count);
+		static uint64 ReadBigEndian64(const uint8* data);
+		static uint64 ReadLittleEndian48(const uint8* data);
+		static void UnpackRGB565(uint32 color, int32* rgb);
+		static int32 SignExtend3(int32 value);
+		static int32 Extend4(int32 value);
+		static int32 Extend5(int32 value);
+		static int32 Extend6(int32 value);
+		static int32 Extend7(int32 value);
+		static uint8 Clamp(int32 value);
+
+		TextureCompression();
+		~TextureCompression();
+
+		TextureCompression(const TextureCompression& yRef);
+		TextureCompression(TextureCompression&& yRef);
+		TextureCompression& operator=(const TextureCompression& yRef);
+		TextureCompression& operator=(TextureCompression&& yRef);
+	};
+}
@@ -0,0 +1,82 @@
+#include "TextureHandle.h"
+#include "Texture2D.h"
+#include "TextureManager.h"
+
+namespace star
+{
+	TextureHandle::TextureHandle()
+		: m_Name()
+		, m_pEntry()
+	{
+
+	}
+
+	TextureHandle::TextureHandle(const tstring & name, const std::shared_ptr<TextureEntry> & entry)
+		: m_Name(name)
+		, m_pEntry(entry)
+	{
+
+	}
+
+	TextureHandle::TextureHandle(const TextureHandle & yRef)
+		: m_Name(yRef.m_Name)
+		, m_pEntry(yRef.m_pEntry)
+	{
+
+	}
+
+	TextureHandle & TextureHandle::operator=(const TextureHandle & yRef)
+	{
+		m_Name = yRef.m_Name;
+		m_pEntry = yRef.m_pEntry;
+		return *this;
+	}
+
+	TextureHandle::~TextureHandle()
+	{
+
+	}
+
+	bool TextureHandle::IsValid() const
+	{
+		return m_pEntry != nullptr && m_pEntry->texture != nullptr;
+	}
+
+	bool TextureHandle::IsReady() const
+	{
+		return IsValid() && m_pEntry->texture->IsReady();
+	}
+
+	bool TextureHandle::HasFailed() const
+	{
+		return !IsValid() || m_pEntry->texture->HasFailed();
+	}
+
+	const tstring & TextureHandle::GetName() const
+	{
+		return m_Name;
+	}
+
+	GLuint TextureHandle::GetTextureID() const
+	{
+		if(!IsValid())
+		{
+			return 0;
+		}
+		const Texture2D* texture = m_pEntry->texture.get();
+		if(!texture->IsReady() && !texture->HasFailed())
+		{
+			return TextureManager::GetInstance()->GetPlaceholderTextureID();
+		}
+		return texture->GetTextureID();
+	}
+
+	ivec2 TextureHandle::GetDimensions() const
+	{
+		if(!IsValid())
+		{
+			return ivec2(0, 0);
+		}
+		return ivec2(m_pEntry->texture->GetWidth(), m_pEntry->texture->GetHeight());
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include "../defines.h"
+
+#ifdef DESKTOP
+#include <glew.h>
+#else
+#include "GLES/gl.h"
+#endif
+
+namespace star
+{
+	class Texture2D;
+
+	//[NOTE]	Entry of a texture name in the TextureManager.
+	//			Every TextureHandle of the name shares the entry, so textures
+	//			with handles left are never evicted from the memory budget.
+	//			The texture is swapped when the name is evicted or reloaded.
+	struct TextureEntry
+	{
+		TextureEntry(const tstring & filePath)
+			: path(filePath)
+			, texture()
+			, pendingTexture()
+			, lastUsedFrame(0)
+		{
+
+		}
+
+		tstring path;
+		//Empty while evicted
+		std::shared_ptr<Texture2D> texture;
+		//Variant that replaces the texture once it's uploaded
+		std::shared_ptr<Texture2D> pendingTexture;
+		uint32 lastUsedFrame;
+	};
+
+	//[NOTE]	Returned by TextureManager::LoadTextureAsync and GetTextureHandle.
+	//			The handle is valid right away, but the texture is only
+	//			ready once a worker decoded it and it got uploaded.
+	//			Until then GetTextureID returns the placeholder texture.
+	class TextureHandle final
+	{
+	public:
+		TextureHandle();
+		TextureHandle(const tstring & name, const std::shared_ptr<TextureEntry> & entry);
+		TextureHandle(const TextureHandle & yRef);
+		TextureHandle & operator=(const TextureHandle & yRef);
+		~TextureHandle();
+
+		bool IsValid() const;
+		bool IsReady() const;
+		bool HasFailed() const;
+
+		const tstring & GetName() const;
+		GLuint GetTextureID() const;
+		//Known before decoding, it's read from the image header
+		ivec2 GetDimensions() const;
+
+	private:
+		tstring m_Name;
+		std::shared_ptr<TextureEntry> m_pEntry;
+	};
+}
@@ -2,6 +2,13 @@
 #include "../Logger.h"
 #include "../Context.h"
 #include "Texture2D.h"
+#include "TextureAtlas.h"
+#include "GLStateCache.h"
+#include "GraphicsManager.h"
+#include "ScaleSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
 
 #ifdef ANDROID
 #include "../StarEngine.h"
@@ -9,27 +16,66 @@
 
 namespace star 
 {
+	const float64 TextureManager::DEFAULT_UPLOAD_BUDGET = 2.0;
+
 	TextureManager::~TextureManager()
 	{
+		StopDecodeThreads();
+		ClearPendingTextures();
+		//Handles can outlive the manager, their textures can't outlive the atlas
+		for(auto & it : m_TextureMap)
+		{
+			it.second->texture.reset();
+			it.second->pendingTexture.reset();
+		}
 		m_TextureMap.clear();
 		m_PathList.clear();
+		if(m_PlaceholderTextureID != 0)
+		{
+			GLStateCache::GetInstance()->DeleteTextures(1, &m_PlaceholderTextureID);
+		}
+		SafeDelete(m_pAtlas);
 	}
 
 	TextureManager::TextureManager(void)
 		: m_TextureMap()
 		, m_PathList()
+		, m_pAtlas(nullptr)
+		, m_bUseAtlas(false)
+		, m_DecodeThreads()
+		, m_QueueMutex()
+		, m_DecodeCondition()
+		, m_DecodeQueue()
+		, m_UploadQueue()
+		, m_DecodingCount(0)
+		, m_bStopDecoding(false)
+		, m_UploadBudget(DEFAULT_UPLOAD_BUDGET)
+		, m_PlaceholderTextureID(0)
+		, m_MemoryBudget(0)
+		, m_EvictionCount(0)
+		, m_RestoreCount(0)
+		, m_bUseScaleVariants(false)
+		, m_VariantScale(1.0f)
 	{
 
 	}
 
 	void TextureManager::LoadTexture(const tstring& path, const tstring& name)
 	{
-
-		if(m_TextureMap.find(name) != m_TextureMap.end())
+		auto it = m_TextureMap.find(name);
+		if(it != m_TextureMap.end())
 		{
+			it->second->lastUsedFrame = GraphicsManager::GetInstance()->GetFrameCount();
+			if(it->second->texture == nullptr)
+			{
+				RestoreTexture(*it->second, false);
+			}
 			return;
 		}
 
+		auto entry = std::make_shared<TextureEntry>(path);
+		entry->lastUsedFrame = GraphicsManager::GetInstance()->GetFrameCount();
+
 		auto pathit = m_PathList.find(path);
 		if(pathit != m_PathList.end())
 		{
@@ -37,23 +83,276 @@ namespace star
 			auto nameit = m_TextureMap.find(nameOld);
 			if(nameit != m_TextureMap.end())
 			{
-				m_TextureMap[name] = nameit->second;
+				if(nameit->second->texture == nullptr)
+				{
+					RestoreTexture(*nameit->second, false);
+				}
+				entry->texture = nameit->second->texture;
+				m_TextureMap[name] = entry;
 				return;
 			}
 			m_PathList.erase(pathit);
-			return;
 		}
 
-		m_TextureMap[name] = std::make_shared<Texture2D>(path);
-		
+		entry->texture = CreateTexture(path, false);
+		m_TextureMap[name] = entry;
 		m_PathList[path] = name;
 	}
 
+	TextureHandle TextureManager::GetTextureHandle(const tstring& name)
+	{
+		auto it = m_TextureMap.find(name);
+		if(it == m_TextureMap.end())
+		{
+			return TextureHandle();
+		}
+		FindTexture(name);
+		return TextureHandle(name, it->second);
+	}
+
+	TextureHandle TextureManager::LoadTextureAsync(const tstring& path, const tstring& name)
+	{
+		auto it = m_TextureMap.find(name);
+		if(it != m_TextureMap.end())
+		{
+			FindTexture(name);
+			return TextureHandle(name, it->second);
+		}
+
+		auto entry = std::make_shared<TextureEntry>(path);
+		entry->lastUsedFrame = GraphicsManager::GetInstance()->GetFrameCount();
+
+		auto pathit = m_PathList.find(path);
+		if(pathit != m_PathList.end())
+		{
+			auto nameit = m_TextureMap.find(pathit->second);
+			if(nameit != m_TextureMap.end())
+			{
+				FindTexture(pathit->second);
+				entry->texture = nameit->second->texture;
+				m_TextureMap[name] = entry;
+				return TextureHandle(name, entry);
+			}
+			m_PathList.erase(pathit);
+		}
+
+		entry->texture = CreateTexture(path, true);
+		m_TextureMap[name] = entry;
+		m_PathList[path] = name;
+		return TextureHandle(name, entry);
+	}
+
+	std::shared_ptr<Texture2D> TextureManager::CreateTexture(const tstring& path, bool deferLoading)
+	{
+		auto texture = std::make_shared<Texture2D>(
+			path, m_bUseAtlas ? m_pAtlas : nullptr, deferLoading, m_VariantScale);
+		if(!deferLoading)
+		{
+			return texture;
+		}
+
+		StartDecodeThreads();
+		{
+			std::lock_guard<std::mutex> lock(m_QueueMutex);
+			m_DecodeQueue.push_back(texture);
+		}
+		m_DecodeCondition.notify_one();
+		return texture;
+	}
+
+	TextureEntry* TextureManager::FindTexture(const tstring& name)
+	{
+		auto it = m_TextureMap.find(name);
+		if(it == m_TextureMap.end())
+		{
+			return nullptr;
+		}
+
+		TextureEntry & entry = *it->second;
+		entry.lastUsedFrame = GraphicsManager::GetInstance()->GetFrameCount();
+		if(entry.texture == nullptr)
+		{
+			RestoreTexture(entry, true);
+		}
+		return &entry;
+	}
+
+	void TextureManager::RestoreTexture(TextureEntry& entry, bool deferLoading)
+	{
+		//Aliases of the same file share one texture
+		for(auto & it : m_TextureMap)
+		{
+			if(it.second->texture != nullptr && it.second->path == entry.path)
+			{
+				entry.texture = it.second->texture;
+				return;
+			}
+		}
+
+		DEBUG_LOG(LogLevel::Info,
+			_T("TextureManager::RestoreTexture: Reloading evicted texture '")
+			+ entry.path + _T("'."), STARENGINE_LOG_TAG);
+		entry.texture = CreateTexture(entry.path, deferLoading);
+		++m_RestoreCount;
+	}
+
+	bool TextureManager::IsTextureLoading(const tstring& name)
+	{
+		auto it = m_TextureMap.find(name);
+		if(it == m_TextureMap.end() || it->second->texture == nullptr)
+		{
+			return false;
+		}
+		const Texture2D* texture = it->second->texture.get();
+		return !texture->IsReady() && !texture->HasFailed();
+	}
+
+	uint32 TextureManager::GetPendingTextureCount()
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		return m_DecodeQueue.size() + m_UploadQueue.size() + m_DecodingCount;
+	}
+
+	void TextureManager::UploadDecodedTextures()
+	{
+		UpdateVariantScale();
+		EnforceMemoryBudget();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		//At least one texture gets uploaded every frame,
+		//so a tight budget can't stall loading completely.
+		bool isFirst(true);
+		for(;;)
+		{
+			std::shared_ptr<Texture2D> texture;
+			{
+				std::lock_guard<std::mutex> lock(m_QueueMutex);
+				if(m_UploadQueue.empty())
+				{
+					return;
+				}
+				texture = m_UploadQueue.front();
+				m_UploadQueue.pop_front();
+			}
+
+			//Skip textures that got deleted while decoding
+			if(!texture.unique())
+			{
+				texture->Upload();
+				SwapPendingTexture(texture);
+			}
+
+			auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::high_resolution_clock::now() - start);
+			if(!isFirst && float64(elapsed.count()) / 1000.0 >= m_UploadBudget)
+			{
+				return;
+			}
+			isFirst = false;
+		}
+	}
+
+	void TextureManager::SetUploadBudget(float64 milliseconds)
+	{
+		m_UploadBudget = milliseconds;
+	}
+
+	GLuint TextureManager::GetPlaceholderTextureID()
+	{
+		if(m_PlaceholderTextureID == 0)
+		{
+			const uint8 pixel[4] = { 128, 128, 128, 255 };
+			glGenTextures(1, &m_PlaceholderTextureID);
+			GLStateCache::GetInstance()->BindTexture(m_PlaceholderTextureID);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+		}
+		return m_PlaceholderTextureID;
+	}
+
+	void TextureManager::StartDecodeThreads()
+	{
+		if(!m_DecodeThreads.empty())
+		{
+			return;
+		}
+
+		//Leave a core for the main thread
+		uint32 threadCount = std::thread::hardware_concurrency();
+		threadCount = std::max<uint32>(threadCount, 2) - 1;
+		if(threadCount > MAX_DECODE_THREADS)
+		{
+			threadCount = MAX_DECODE_THREADS;
+		}
+		m_bStopDecoding = false;
+		for(uint32 i = 0; i < threadCount; ++i)
+		{
+			m_DecodeThreads.push_back(std::thread(&TextureManager::DecodeThreadLoop, this));
+		}
+	}
+
+	void TextureManager::StopDecodeThreads()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_QueueMutex);
+			m_bStopDecoding = true;
+		}
+		m_DecodeCondition.notify_all();
+		for(auto & thread : m_DecodeThreads)
+		{
+			thread.join();
+		}
+		m_DecodeThreads.clear();
+	}
+
+	void TextureManager::DecodeThreadLoop()
+	{
+		//[NOTE]	No logging and no GL calls in here.
+		//			Decode keeps its errors, they're logged on Upload.
+		std::unique_lock<std::mutex> lock(m_QueueMutex);
+		for(;;)
+		{
+			m_DecodeCondition.wait(lock, [this]()
+			{
+				return m_bStopDecoding || !m_DecodeQueue.empty();
+			});
+			if(m_bStopDecoding)
+			{
+				return;
+			}
+
+			std::shared_ptr<Texture2D> texture = m_DecodeQueue.front();
+			m_DecodeQueue.pop_front();
+			++m_DecodingCount;
+
+			lock.unlock();
+			texture->Decode();
+			lock.lock();
+
+			--m_DecodingCount;
+			//Moved, so the last reference is never released on this thread
+			m_UploadQueue.push_back(std::move(texture));
+		}
+	}
+
+	void TextureManager::ClearPendingTextures()
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		m_DecodeQueue.clear();
+		m_UploadQueue.clear();
+	}
+
 	bool TextureManager::DeleteTexture(const tstring& name)
 	{
 		auto it = m_TextureMap.find(name);
 		if(it != m_TextureMap.end())
 		{
+			//A handle can keep the entry, not the variant it was waiting for
+			it->second->pendingTexture.reset();
 			m_TextureMap.erase(it);
 			return true;
 		}
@@ -62,36 +361,342 @@ namespace star
 
 	GLuint TextureManager::GetTextureID(const tstring& name)
 	{
-		if(m_TextureMap.find(name) != m_TextureMap.end())
+		TextureEntry* entry = FindTexture(name);
+		if(entry != nullptr)
 		{
-			return m_TextureMap[name]->GetTextureID();
+			const Texture2D* texture = entry->texture.get();
+			if(!texture->IsReady() && !texture->HasFailed())
+			{
+				return GetPlaceholderTextureID();
+			}
+			return texture->GetTextureID();
 		}
 		return 0;
 	}
 
 	ivec2 TextureManager::GetTextureDimensions(const tstring& name)
 	{
-		auto it = m_TextureMap.find(name);
-		if(it != m_TextureMap.end())
+		TextureEntry* entry = FindTexture(name);
+		if(entry != nullptr)
 		{
-			return (ivec2(it->second->GetWidth(), it->second->GetHeight()));
+			return (ivec2(entry->texture->GetWidth(), entry->texture->GetHeight()));
 		}
 		return ivec2(0,0);
 	}
 
+	vec4 TextureManager::GetTextureUVRegion(const tstring& name)
+	{
+		TextureEntry* entry = FindTexture(name);
+		if(entry != nullptr)
+		{
+			return entry->texture->GetUVRegion();
+		}
+		return vec4(0, 0, 1, 1);
+	}
+
 	void TextureManager::EraseAllTextures()
 	{
+		 ClearPendingTextures();
+		 //Handles keep their entry, but not the GL texture
+		 for(auto & it : m_TextureMap)
+		 {
+			 it.second->texture.reset();
+			 it.second->pendingTexture.reset();
+		 }
 		 m_TextureMap.clear();
 		 m_PathList.clear();
+		 if(m_pAtlas != nullptr)
+		 {
+			 m_pAtlas->Clear();
+		 }
 	}
 
 	bool TextureManager::ReloadAllTextures()
 	{
-		m_TextureMap.clear();
-		for(auto it = m_PathList.begin(); it != m_PathList.end(); ++it)
+		//Pending textures are reloaded synchronously as well
+		ClearPendingTextures();
+		for(auto & it : m_TextureMap)
 		{
-			m_TextureMap[it->second] = std::make_shared<Texture2D>(it->first);
+			it.second->texture.reset();
+			it.second->pendingTexture.reset();
+		}
+		//The old context took the placeholder with it
+		m_PlaceholderTextureID = 0;
+		if(m_pAtlas != nullptr)
+		{
+			m_pAtlas->Clear();
+		}
+		//The entries are kept, so existing handles get the new textures
+		for(auto & it : m_TextureMap)
+		{
+			if(it.second->texture == nullptr)
+			{
+				RestoreTexture(*it.second, false);
+			}
 		}
 		return true;
 	}
+
+	void TextureManager::SetMemoryBudget(uint64 bytes)
+	{
+		m_MemoryBudget = bytes;
+	}
+
+	uint64 TextureManager::GetMemoryBudget() const
+	{
+		return m_MemoryBudget;
+	}
+
+	TextureMemoryStats TextureManager::GetMemoryStats()
+	{
+		TextureMemoryStats stats;
+		stats.budget = m_MemoryBudget;
+		stats.evictions = m_EvictionCount;
+		stats.restores = m_RestoreCount;
+		if(m_pAtlas != nullptr)
+		{
+			uint64 pageSize = m_pAtlas->GetPageSize();
+			stats.atlasBytes = m_pAtlas->GetPageCount() * pageSize * pageSize * 4;
+		}
+
+		std::set<const Texture2D*> counted;
+		for(auto & it : m_TextureMap)
+		{
+			const TextureEntry & entry = *it.second;
+			if(!it.second.unique())
+			{
+				++stats.referencedNames;
+			}
+			if(entry.texture == nullptr)
+			{
+				++stats.evictedNames;
+			}
+			else if(counted.insert(entry.texture.get()).second)
+			{
+				stats.textureBytes += entry.texture->GetMemorySize();
+				++stats.textureCount;
+			}
+		}
+		return stats;
+	}
+
+	uint64 TextureManager::GetMemoryUsage()
+	{
+		TextureMemoryStats stats = GetMemoryStats();
+		return stats.textureBytes + stats.atlasBytes;
+	}
+
+	void TextureManager::EnforceMemoryBudget()
+	{
+		if(m_MemoryBudget == 0)
+		{
+			return;
+		}
+
+		uint64 usage = GetMemoryUsage();
+		if(usage <= m_MemoryBudget)
+		{
+			return;
+		}
+
+		//A texture can only go when none of its names has a handle.
+		//Textures used this or last frame are kept to avoid reloading
+		//them every frame when the budget is too small.
+		struct Candidate
+		{
+			Texture2D* texture;
+			uint32 lastUsedFrame;
+			bool bIsEvictable;
+		};
+		std::vector<Candidate> candidates;
+		uint32 frame = GraphicsManager::GetInstance()->GetFrameCount();
+		for(auto & it : m_TextureMap)
+		{
+			const TextureEntry & entry = *it.second;
+			Texture2D* texture = entry.texture.get();
+			if(texture == nullptr)
+			{
+				continue;
+			}
+
+			auto candidate = std::find_if(candidates.begin(), candidates.end(),
+				[texture](const Candidate & c) -> bool
+			{
+				return c.texture == texture;
+			});
+			if(candidate == candidates.end())
+			{
+				Candidate c;
+				c.texture = texture;
+				c.lastUsedFrame = entry.lastUsedFrame;
+				c.bIsEvictable = texture->IsReady() && !texture->IsAtlasTexture();
+				candidates.push_back(c);
+				candidate = candidates.end() - 1;
+			}
+			candidate->lastUsedFrame = std::max(candidate->lastUsedFrame, entry.lastUsedFrame);
+			candidate->bIsEvictable = candidate->bIsEvictable && it.second.unique()
+				&& entry.lastUsedFrame + 1 < frame;
+		}
+
+		std::sort(candidates.begin(), candidates.end(),
+			[](const Candidate & a, const Candidate & b) -> bool
+		{
+			return a.lastUsedFrame < b.lastUsedFrame;
+		});
+
+		for(const Candidate & candidate : candidates)
+		{
+			if(usage <= m_MemoryBudget)
+			{
+				break;
+			}
+			if(!candidate.bIsEvictable)
+			{
+				continue;
+			}
+
+			usage -= candidate.texture->GetMemorySize();
+			DEBUG_LOG(LogLevel::Info,
+				_T("TextureManager::EnforceMemoryBudget: Evicting '")
+				+ candidate.texture->GetPath() + _T("'."), STARENGINE_LOG_TAG);
+			for(auto & it : m_TextureMap)
+			{
+				if(it.second->texture.get() == candidate.texture)
+				{
+					//Releases the texture once the last alias lets go
+					it.second->texture.reset();
+					it.second->pendingTexture.reset();
+				}
+			}
+			++m_EvictionCount;
+		}
+	}
+
+	void TextureManager::SetScaleVariantsEnabled(bool enabled)
+	{
+		m_bUseScaleVariants = enabled;
+		UpdateVariantScale();
+	}
+
+	bool TextureManager::IsScaleVariantsEnabled() const
+	{
+		return m_bUseScaleVariants;
+	}
+
+	float32 TextureManager::GetVariantScale() const
+	{
+		return m_VariantScale;
+	}
+
+	float32 TextureManager::CalculateVariantScale() const
+	{
+		//The smallest variant that still isn't magnified on screen.
+		//The scale is 0 until a working resolution is set.
+		float32 scale = ScaleSystem::GetInstance()->GetScale();
+		if(!m_bUseScaleVariants || scale <= 0.0f || scale > 0.5f)
+		{
+			return 1.0f;
+		}
+		return scale > 0.25f ? 0.5f : 0.25f;
+	}
+
+	void TextureManager::UpdateVariantScale()
+	{
+		float32 scale = CalculateVariantScale();
+		if(scale == m_VariantScale)
+		{
+			return;
+		}
+		m_VariantScale = scale;
+
+		//Aliases share their texture, so it's only reloaded once.
+		//Every reload is decoded on the decode threads, a texture that
+		//is drawn already stays bound until SwapPendingTexture.
+		std::map<const Texture2D*, std::shared_ptr<Texture2D>> reloaded;
+		for(auto & it : m_TextureMap)
+		{
+			TextureEntry & entry = *it.second;
+			const Texture2D* texture = entry.texture.get();
+			if(texture == nullptr || texture->IsAtlasTexture()
+				|| texture->HasFailed() || texture->GetScale() == scale)
+			{
+				//Back at the scale that is bound, the pending one is dropped
+				entry.pendingTexture.reset();
+				continue;
+			}
+			if(entry.pendingTexture != nullptr
+				&& entry.pendingTexture->GetScale() == scale)
+			{
+				continue;
+			}
+
+			auto reloadit = reloaded.find(texture);
+			if(reloadit == reloaded.end())
+			{
+				reloadit = reloaded.insert(std::make_pair(
+					texture, CreateTexture(entry.path, true))).first;
+			}
+			//Textures that were still loading only had the placeholder
+			if(texture->IsReady())
+			{
+				entry.pendingTexture = reloadit->second;
+			}
+			else
+			{
+				entry.pendingTexture.reset();
+				entry.texture = reloadit->second;
+			}
+		}
+	}
+
+	void TextureManager::SwapPendingTexture(const std::shared_ptr<Texture2D> & texture)
+	{
+		//A variant that failed to load is dropped, the old one stays
+		for(auto & it : m_TextureMap)
+		{
+			TextureEntry & entry = *it.second;
+			if(entry.pendingTexture != texture)
+			{
+				continue;
+			}
+			if(!texture->HasFailed())
+			{
+				entry.texture = texture;
+			}
+			entry.pendingTexture.reset();
+		}
+	}
+
+	void TextureManager::SetAtlasEnabled(bool enabled, int32 pageSize, int32 maxTextureSize)
+	{
+		m_bUseAtlas = enabled;
+		if(!enabled)
+		{
+			//Keep the atlas alive, already packed textures still use its pages
+			return;
+		}
+
+		if(m_pAtlas == nullptr)
+		{
+			m_pAtlas = new TextureAtlas(pageSize, maxTextureSize);
+		}
+		else if(m_pAtlas->GetPageSize() != pageSize
+			|| m_pAtlas->GetMaxTextureSize() != maxTextureSize)
+		{
+			LOG(LogLevel::Warning,
+				_T("TextureManager::SetAtlasEnabled: The atlas already exists, \
+the page size and max texture size can't be changed anymore."),
+				STARENGINE_LOG_TAG);
+		}
+	}
+
+	bool TextureManager::IsAtlasEnabled() const
+	{
+		return m_bUseAtlas;
+	}
+
+	uint32 TextureManager::GetAtlasPageCount() const
+	{
+		return m_pAtlas != nullptr ? m_pAtlas->GetPageCount() : 0;
+	}
 }
@@ -2,8 +2,14 @@
 
 #include <map>
 #include <memory>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "../defines.h"
 #include "../Helpers/Singleton.h"
+#include "TextureHandle.h"
 
 #ifdef DESKTOP
 #include <glew.h>
@@ -14,6 +20,35 @@
 namespace star
 {
 	class Texture2D;
+	class TextureAtlas;
+
+	//Texture memory of the TextureManager, to tune the budget per device
+	struct TextureMemoryStats
+	{
+		TextureMemoryStats()
+			: textureBytes(0)
+			, atlasBytes(0)
+			, budget(0)
+			, textureCount(0)
+			, referencedNames(0)
+			, evictedNames(0)
+			, evictions(0)
+			, restores(0)
+		{}
+
+		//Textures with their own GL texture, aliases counted once
+		uint64 textureBytes;
+		//All atlas pages, these are never evicted
+		uint64 atlasBytes;
+		uint64 budget;
+		uint32 textureCount;
+		//Names that still have TextureHandles
+		uint32 referencedNames;
+		uint32 evictedNames;
+		//Totals since the start
+		uint32 evictions;
+		uint32 restores;
+	};
 
 	class TextureManager final : public Singleton<TextureManager>
 	{
@@ -21,15 +56,103 @@ namespace star
 		friend Singleton<TextureManager>;
 
 		void LoadTexture(const tstring& path, const tstring& name);
+		//Holding the handle keeps the texture from being evicted
+		TextureHandle GetTextureHandle(const tstring& name);
+		//[NOTE]	Returns immediately, the png is decoded on a worker thread
+		//			and uploaded in UploadDecodedTextures.
+		//			Until then GetTextureID returns the placeholder texture,
+		//			the dimensions are already known.
+		TextureHandle LoadTextureAsync(const tstring& path, const tstring& name);
+		bool IsTextureLoading(const tstring& name);
+		uint32 GetPendingTextureCount();
+		//Uploads decoded textures until the budget is spent,
+		//called once a frame on the thread owning the GL context.
+		void UploadDecodedTextures();
+		void SetUploadBudget(float64 milliseconds);
+		GLuint GetPlaceholderTextureID();
+
 		bool DeleteTexture(const tstring& name);
 		GLuint GetTextureID(const tstring& name);
 		ivec2 GetTextureDimensions(const tstring& name);
+		vec4 GetTextureUVRegion(const tstring& name);
 		void EraseAllTextures();
 		bool ReloadAllTextures();
 
+		//[NOTE]	Only affects textures loaded after this call.
+		//			Textures up to maxTextureSize get packed into
+		//			shared pages of pageSize x pageSize.
+		void SetAtlasEnabled(
+			bool enabled,
+			int32 pageSize = DEFAULT_ATLAS_PAGE_SIZE,
+			int32 maxTextureSize = DEFAULT_ATLAS_MAX_TEXTURE_SIZE
+			);
+		bool IsAtlasEnabled() const;
+		uint32 GetAtlasPageCount() const;
+
+		//[NOTE]	When the textures and atlas pages use more than the budget,
+		//			the least recently used textures without TextureHandles
+		//			are evicted at the start of the next frame.
+		//			They are reloaded from their path when they're used again.
+		//			A budget of 0 disables eviction, which is the default.
+		void SetMemoryBudget(uint64 bytes);
+		uint64 GetMemoryBudget() const;
+		TextureMemoryStats GetMemoryStats();
+
+		//[NOTE]	Loads textures at half or a quarter of their resolution
+		//			when the ScaleSystem draws the scene that much smaller,
+		//			see the Texture2D constructor for the variant files.
+		//			Loaded textures are reloaded once the scale crosses 0.5
+		//			or 0.25, on the decode threads like LoadTextureAsync.
+		//			The old variant is drawn until the new one is uploaded.
+		//			Textures packed in the atlas keep their variant.
+		//			Their reported dimensions never change.
+		void SetScaleVariantsEnabled(bool enabled);
+		bool IsScaleVariantsEnabled() const;
+		//1, 0.5 or 0.25
+		float32 GetVariantScale() const;
+
+		static const int32 DEFAULT_ATLAS_PAGE_SIZE = 1024;
+		static const int32 DEFAULT_ATLAS_MAX_TEXTURE_SIZE = 256;
+		static const float64 DEFAULT_UPLOAD_BUDGET;
+		static const uint32 MAX_DECODE_THREADS = 2;
+
 	private:
-		std::map<tstring, std::shared_ptr<Texture2D>> m_TextureMap;
+		std::shared_ptr<Texture2D> CreateTexture(const tstring& path, bool deferLoading);
+		//Finds the entry and marks it as used, evicted textures are reloaded async
+		TextureEntry* FindTexture(const tstring& name);
+		void RestoreTexture(TextureEntry& entry, bool deferLoading);
+		void EnforceMemoryBudget();
+		uint64 GetMemoryUsage();
+		float32 CalculateVariantScale() const;
+		void UpdateVariantScale();
+		void SwapPendingTexture(const std::shared_ptr<Texture2D> & texture);
+		void StartDecodeThreads();
+		void StopDecodeThreads();
+		void DecodeThreadLoop();
+		void ClearPendingTextures();
+
+		std::map<tstring, std::shared_ptr<TextureEntry>> m_TextureMap;
 		std::map<tstring,tstring> m_PathList;
+		TextureAtlas* m_pAtlas;
+		bool m_bUseAtlas;
+
+		//Both queues are guarded by m_QueueMutex
+		std::vector<std::thread> m_DecodeThreads;
+		std::mutex m_QueueMutex;
+		std::condition_variable m_DecodeCondition;
+		std::deque<std::shared_ptr<Texture2D>> m_DecodeQueue;
+		std::deque<std::shared_ptr<Texture2D>> m_UploadQueue;
+		uint32 m_DecodingCount;
+		bool m_bStopDecoding;
+		float64 m_UploadBudget;
+		GLuint m_PlaceholderTextureID;
+
+		uint64 m_MemoryBudget;
+		uint32 m_EvictionCount,
+			   m_RestoreCount;
+
+		bool m_bUseScaleVariants;
+		float32 m_VariantScale;
 
 		TextureManager();
 		~TextureManager();
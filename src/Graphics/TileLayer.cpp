@@ -0,0 +1,334 @@
+#include "TileLayer.h"
+#include "TextureManager.h"
+#include "GraphicsManager.h"
+#include "GLStateCache.h"
+#include "../Logger.h"
+#include "../Helpers/Helpers.h"
+#include <algorithm>
+
+namespace star
+{
+	TileLayer::TileLayer(uint32 width, uint32 height, const vec2 & tileSize, lay layer)
+		: m_Width(width)
+		, m_Height(height)
+		, m_ChunksX((width + CHUNK_SIZE - 1) / CHUNK_SIZE)
+		, m_ChunksY((height + CHUNK_SIZE - 1) / CHUNK_SIZE)
+		, m_TileSize(tileSize)
+		, m_Layer(layer)
+		, m_Gids(width * height, 0)
+		, m_TileSets()
+		, m_Chunks(m_ChunksX * m_ChunksY)
+	{
+
+	}
+
+	TileLayer::~TileLayer()
+	{
+		for(Chunk & chunk : m_Chunks)
+		{
+			if(chunk.vertexBufferID != 0)
+			{
+				GLStateCache::GetInstance()->DeleteBuffers(1, &chunk.vertexBufferID);
+			}
+		}
+	}
+
+	void TileLayer::AddTileSet(
+		uint32 firstGid,
+		const tstring & textureName,
+		uint32 columns,
+		uint32 rows,
+		const vec2 & tileSize
+		)
+	{
+		TileSet set;
+		set.firstGid = firstGid;
+		set.textureName = textureName;
+		set.columns = std::max<uint32>(columns, 1);
+		set.rows = std::max<uint32>(rows, 1);
+		set.tileSize = tileSize;
+
+		//Keep the tilesets sorted on their first gid
+		auto it = std::upper_bound(m_TileSets.begin(), m_TileSets.end(), set,
+			[](const TileSet & a, const TileSet & b) -> bool
+		{
+			return a.firstGid < b.firstGid;
+		});
+		m_TileSets.insert(it, set);
+
+		for(Chunk & chunk : m_Chunks)
+		{
+			chunk.bIsDirty = true;
+		}
+	}
+
+	void TileLayer::SetTile(uint32 x, uint32 y, uint32 gid)
+	{
+		if(x >= m_Width || y >= m_Height)
+		{
+			LOG(LogLevel::Warning,
+				_T("TileLayer::SetTile: Tile (") + string_cast<tstring>(x) +
+				_T(", ") + string_cast<tstring>(y) + _T(") is out of bounds."),
+				STARENGINE_LOG_TAG);
+			return;
+		}
+
+		uint32 & tile = m_Gids[x + y * m_Width];
+		if(tile != gid)
+		{
+			tile = gid;
+			m_Chunks[x / CHUNK_SIZE + (y / CHUNK_SIZE) * m_ChunksX].bIsDirty = true;
+		}
+	}
+
+	uint32 TileLayer::GetTile(uint32 x, uint32 y) const
+	{
+		if(x >= m_Width || y >= m_Height)
+		{
+			return 0;
+		}
+		return m_Gids[x + y * m_Width];
+	}
+
+	void TileLayer::Draw()
+	{
+		UpdateTileSets();
+		for(uint32 i = 0; i < m_Chunks.size(); ++i)
+		{
+			UpdateChunk(i);
+			QueueChunk(m_Chunks[i]);
+		}
+	}
+
+	void TileLayer::Draw(float32 left, float32 right, float32 top, float32 bottom)
+	{
+		UpdateTileSets();
+		for(uint32 i = 0; i < m_Chunks.size(); ++i)
+		{
+			UpdateChunk(i);
+
+			const vec4 & bounds = m_Chunks[i].bounds;
+			if(bounds.x <= right && bounds.z >= left
+				&& bounds.y <= top && bounds.w >= bottom)
+			{
+				QueueChunk(m_Chunks[i]);
+			}
+		}
+	}
+
+	uint32 TileLayer::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	uint32 TileLayer::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	lay TileLayer::GetLayer() const
+	{
+		return m_Layer;
+	}
+
+	void TileLayer::UpdateTileSets()
+	{
+		//Textures get new IDs or atlas regions when they are reloaded,
+		//the chunks have to be rebuilt in that case.
+		bool changed(false);
+		for(TileSet & set : m_TileSets)
+		{
+			GLuint textureID = TextureManager::GetInstance()->GetTextureID(set.textureName);
+			vec4 uvRegion = TextureManager::GetInstance()->GetTextureUVRegion(set.textureName);
+			if(textureID != set.textureID || uvRegion != set.uvRegion)
+			{
+				set.textureID = textureID;
+				set.uvRegion = uvRegion;
+				changed = true;
+			}
+		}
+
+		if(changed)
+		{
+			for(Chunk & chunk : m_Chunks)
+			{
+				chunk.bIsDirty = true;
+			}
+		}
+	}
+
+	void TileLayer::UpdateChunk(uint32 chunkIndex)
+	{
+		const Chunk & chunk = m_Chunks[chunkIndex];
+		if(chunk.bIsDirty || chunk.bInVertexBuffer !=
+			SpriteBatch::GetInstance()->IsVertexBufferStreamingEnabled())
+		{
+			RebuildChunk(chunkIndex);
+		}
+	}
+
+	void TileLayer::RebuildChunk(uint32 chunkIndex)
+	{
+		Chunk & chunk = m_Chunks[chunkIndex];
+		chunk.vertices.clear();
+		chunk.batches.clear();
+		chunk.bounds = vec4(0, 0, 0, 0);
+		chunk.bIsDirty = false;
+		chunk.bInVertexBuffer = SpriteBatch::GetInstance()->IsVertexBufferStreamingEnabled();
+
+		uint32 startX = (chunkIndex % m_ChunksX) * CHUNK_SIZE;
+		uint32 startY = (chunkIndex / m_ChunksX) * CHUNK_SIZE;
+		uint32 endX = std::min(startX + CHUNK_SIZE, m_Width);
+		uint32 endY = std::min(startY + CHUNK_SIZE, m_Height);
+
+		//Look up the tileset of every tile once
+		int32 tileSets[CHUNK_SIZE * CHUNK_SIZE];
+		for(uint32 y = startY; y < endY; ++y)
+		{
+			for(uint32 x = startX; x < endX; ++x)
+			{
+				uint32 gid = m_Gids[x + y * m_Width];
+				tileSets[(x - startX) + (y - startY) * CHUNK_SIZE] =
+					gid == 0 ? -1 : GetTileSetIndex(gid);
+			}
+		}
+
+		//Group the quads per tileset, so every tileset is one draw call
+		for(uint32 setIndex = 0; setIndex < m_TileSets.size(); ++setIndex)
+		{
+			const TileSet & set = m_TileSets[setIndex];
+			uint32 firstQuad = chunk.vertices.size() / 4;
+			for(uint32 y = startY; y < endY; ++y)
+			{
+				for(uint32 x = startX; x < endX; ++x)
+				{
+					if(tileSets[(x - startX) + (y - startY) * CHUNK_SIZE] == int32(setIndex))
+					{
+						PushTile(chunk, set, x, y, m_Gids[x + y * m_Width]);
+					}
+				}
+			}
+
+			uint32 quadAmount = chunk.vertices.size() / 4 - firstQuad;
+			if(quadAmount > 0)
+			{
+				QuadBatchInfo batch;
+				batch.start = firstQuad;
+				batch.size = quadAmount;
+				batch.textureID = set.textureID;
+				batch.layer = m_Layer;
+				chunk.batches.push_back(batch);
+			}
+		}
+
+		if(chunk.vertices.empty())
+		{
+			return;
+		}
+
+		if(chunk.bInVertexBuffer)
+		{
+			if(chunk.vertexBufferID == 0)
+			{
+				glGenBuffers(1, &chunk.vertexBufferID);
+			}
+			GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, chunk.vertexBufferID);
+			glBufferData(GL_ARRAY_BUFFER, chunk.vertices.size() * sizeof(SpriteVertex),
+				&chunk.vertices.at(0), GL_STATIC_DRAW);
+			GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, 0);
+			OPENGL_LOG();
+
+			RenderStats & stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+			++stats.bufferUploads;
+			stats.bytesUploaded += chunk.vertices.size() * sizeof(SpriteVertex);
+		}
+
+		for(QuadBatchInfo & batch : chunk.batches)
+		{
+			batch.vertices = &chunk.vertices.at(0);
+			batch.vertexBufferID = chunk.bInVertexBuffer ? chunk.vertexBufferID : 0;
+		}
+	}
+
+	void TileLayer::PushTile(Chunk & chunk, const TileSet & set,
+		uint32 x, uint32 y, uint32 gid)
+	{
+		//Same uvs as a SpriteComponent using the tileset as a spritesheet
+		uint32 localID = gid - set.firstGid;
+		uint32 column = localID % set.columns;
+		uint32 row = set.rows - (localID / set.columns) % set.rows - 1;
+
+		float32 uvWidth = set.uvRegion.z / float32(set.columns);
+		float32 uvHeight = set.uvRegion.w / float32(set.rows);
+		float32 uvLeft = set.uvRegion.x + float32(column) * uvWidth;
+		float32 uvBottom = set.uvRegion.y + float32(row) * uvHeight;
+
+		uint16 uLeft = SpriteBatch::PackUV(uvLeft),
+			   uRight = SpriteBatch::PackUV(uvLeft + uvWidth),
+			   vBottom = SpriteBatch::PackUV(uvBottom),
+			   vTop = SpriteBatch::PackUV(uvBottom + uvHeight);
+
+		//Row 0 is the top row of the map
+		float32 left = float32(x) * m_TileSize.x;
+		float32 bottom = float32(m_Height - y - 1) * m_TileSize.y;
+		float32 right = left + set.tileSize.x;
+		float32 top = bottom + set.tileSize.y;
+
+		if(chunk.vertices.empty())
+		{
+			chunk.bounds = vec4(left, bottom, right, top);
+		}
+		else
+		{
+			chunk.bounds.x = std::min(chunk.bounds.x, left);
+			chunk.bounds.y = std::min(chunk.bounds.y, bottom);
+			chunk.bounds.z = std::max(chunk.bounds.z, right);
+			chunk.bounds.w = std::max(chunk.bounds.w, top);
+		}
+
+		SpriteVertex vertex;
+		vertex.layer = float32(m_Layer) * LAYER_HEIGHT;
+		vertex.r = vertex.g = vertex.b = vertex.a = 255;
+		vertex.flags = 0;
+
+		//TL, TR, BL, BR
+		vertex.x = left;
+		vertex.y = top;
+		vertex.u = uLeft;
+		vertex.v = vTop;
+		chunk.vertices.push_back(vertex);
+
+		vertex.x = right;
+		vertex.u = uRight;
+		chunk.vertices.push_back(vertex);
+
+		vertex.x = left;
+		vertex.y = bottom;
+		vertex.u = uLeft;
+		vertex.v = vBottom;
+		chunk.vertices.push_back(vertex);
+
+		vertex.x = right;
+		vertex.u = uRight;
+		chunk.vertices.push_back(vertex);
+	}
+
+	int32 TileLayer::GetTileSetIndex(uint32 gid) const
+	{
+		//The tileset with the highest first gid that is still <= gid
+		int32 index(-1);
+		for(uint32 i = 0; i < m_TileSets.size() && m_TileSets[i].firstGid <= gid; ++i)
+		{
+			index = int32(i);
+		}
+		return index;
+	}
+
+	void TileLayer::QueueChunk(const Chunk & chunk) const
+	{
+		for(const QuadBatchInfo & batch : chunk.batches)
+		{
+			SpriteBatch::GetInstance()->AddQuadBatchToQueue(&batch);
+		}
+	}
+}
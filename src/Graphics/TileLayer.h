@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include "../defines.h"
+#include "SpriteBatch.h"
+
+namespace star
+{
+	//[NOTE]	One layer of a tile map, stored as a flat array of gids.
+	//			The layer is split in chunks of CHUNK_SIZE x CHUNK_SIZE tiles.
+	//			Every chunk keeps its quads in a static vertex buffer that is
+	//			only rebuilt when one of its tiles changes,
+	//			and is culled and queued in the SpriteBatch as a whole.
+	class TileLayer final
+	{
+	public:
+		static const uint32 CHUNK_SIZE = 16;
+
+		TileLayer(uint32 width, uint32 height, const vec2 & tileSize, lay layer);
+		~TileLayer();
+
+		void AddTileSet(
+			uint32 firstGid,
+			const tstring & textureName,
+			uint32 columns,
+			uint32 rows,
+			const vec2 & tileSize
+			);
+
+		//x and y are in tiles, with y = 0 the top row of the map
+		void SetTile(uint32 x, uint32 y, uint32 gid);
+		uint32 GetTile(uint32 x, uint32 y) const;
+
+		void Draw();
+		void Draw(float32 left, float32 right, float32 top, float32 bottom);
+
+		uint32 GetWidth() const;
+		uint32 GetHeight() const;
+		lay GetLayer() const;
+
+	private:
+		struct TileSet
+		{
+			TileSet()
+				: firstGid(0)
+				, textureName()
+				, columns(1)
+				, rows(1)
+				, tileSize()
+				, textureID(0)
+				, uvRegion(0, 0, 1, 1)
+			{
+
+			}
+
+			uint32 firstGid;
+			tstring textureName;
+			uint32 columns, rows;
+			vec2 tileSize;
+			GLuint textureID;
+			vec4 uvRegion;
+		};
+
+		struct Chunk
+		{
+			Chunk()
+				: vertices()
+				, batches()
+				, vertexBufferID(0)
+				, bounds()
+				, bIsDirty(true)
+				, bInVertexBuffer(false)
+			{
+
+			}
+
+			std::vector<SpriteVertex> vertices;
+			//One batch for every tileset used in this chunk
+			std::vector<QuadBatchInfo> batches;
+			GLuint vertexBufferID;
+			//left, bottom, right, top
+			vec4 bounds;
+			bool bIsDirty;
+			bool bInVertexBuffer;
+		};
+
+		void UpdateTileSets();
+		void UpdateChunk(uint32 chunkIndex);
+		void RebuildChunk(uint32 chunkIndex);
+		void PushTile(Chunk & chunk, const TileSet & set,
+			uint32 x, uint32 y, uint32 gid);
+		int32 GetTileSetIndex(uint32 gid) const;
+		void QueueChunk(const Chunk & chunk) const;
+
+		uint32 m_Width,
+			   m_Height,
+			   m_ChunksX,
+			   m_ChunksY;
+		vec2 m_TileSize;
+		lay m_Layer;
+		std::vector<uint32> m_Gids;
+		std::vector<TileSet> m_TileSets;
+		std::vector<Chunk> m_Chunks;
+
+		TileLayer(const TileLayer& yRef);
+		TileLayer(TileLayer&& yRef);
+		TileLayer& operator=(const TileLayer& yRef);
+		TileLayer& operator=(TileLayer&& yRef);
+	};
+}
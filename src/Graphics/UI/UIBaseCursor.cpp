@@ -46,4 +46,9 @@ namespace star
 			m_State = state;
 		}
 	}
+
+	CullingBoundsType UIBaseCursor::GetCullingBounds(vec4 & bounds) const
+	{
+		return GetContentCullingBounds(bounds);
+	}
 }
@@ -20,6 +20,9 @@ namespace star
 
 		virtual void SetState(const tstring & state);
 
+		//Culled by its sprite, see Object::GetCullingBounds
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+
 	protected:
 		bool m_IsLocked;
 		tstring m_State;
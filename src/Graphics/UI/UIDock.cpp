@@ -122,6 +122,11 @@ namespace star
 		return m_Dimensions;
 	}
 
+	CullingBoundsType UIDock::GetCullingBounds(vec4 & bounds) const
+	{
+		return CullingBoundsType::Unbounded;
+	}
+
 	bool UIDock::CheckCulling(
 			float32 left,
 			float32 right,
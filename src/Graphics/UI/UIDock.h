@@ -31,6 +31,9 @@ namespace star
 
 		virtual vec2 GetDimensions() const;
 
+		//Docks are culled on their own rectangle, not on their components
+		virtual CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+
 	protected:
 		vec2 m_Dimensions;
 		virtual bool CheckCulling(
@@ -376,4 +376,9 @@ namespace star
 	{
 		return m_bCanDebugDraw;
 	}
+
+	CullingBoundsType UIObject::GetCullingBounds(vec4 & bounds) const
+	{
+		return GetContentCullingBounds(bounds);
+	}
 }
@@ -71,6 +71,10 @@ namespace star
 		void SetCanDebugDraw(bool canDraw);
 		bool GetCanDebugDraw() const;
 
+		//Culled by the components and children, see Object::GetCullingBounds.
+		//UI elements that override CheckCulling have to override this as well.
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+
 
 	protected:
 		static uint64 UNIQUE_ID_COUNTER;
@@ -1,21 +1,32 @@
 #include "DebugDraw.h"
 #include "../../Graphics/GraphicsManager.h"
+#include "../../Graphics/GLStateCache.h"
 #include "../../Graphics/ScaleSystem.h"
 #include "../../Logger.h"
 #include "../AARect.h"
 #include "../Rect.h"
 #include "../Helpers.h"
 #include "../Math.h"
+#include <algorithm>
+#include <cstddef>
 
 namespace star
 {
 	DebugDraw::DebugDraw()
 		: Singleton<DebugDraw>()
+		, m_TriangleVertices()
+		, m_LineVertices()
+		, m_PointVertices()
+		, m_CircleVertices()
+		, m_PrimitiveCount(0)
+		, m_VertexBufferID(0)
+		, m_VertexBufferSize(0)
 		, m_PointSize(1.0f)
 		, m_Shader(nullptr)
-		, m_ColorLocation(0)
+		, m_OpacityLocation(0)
 		, m_MVPLocation(0)
 		, m_PositionLocation(0)
+		, m_ColorLocation(0)
 		, m_DrawOpTriangles(0.5f)
 		, m_DrawOpLines(1.0f)
 		, m_DrawOpPoints(1.0f)
@@ -25,6 +36,10 @@ namespace star
 
 	DebugDraw::~DebugDraw()
 	{
+		if(m_VertexBufferID != 0)
+		{
+			GLStateCache::GetInstance()->DeleteBuffers(1, &m_VertexBufferID);
+		}
 		delete m_Shader;
 	}
 
@@ -48,29 +63,36 @@ namespace star
 		static const GLchar* vertexShader = "\
 			uniform mat4 MVP;\
 			attribute vec2 position;\
+			attribute vec3 color;\
+			varying vec3 vertexColor;\
 			void main()\
 			{\
 			  vec4 NewPosition = vec4(position, 0.0, 1.0);\
 			  NewPosition *= MVP;\
 			  gl_Position = NewPosition;\
+			  vertexColor = color;\
 			}\
 			";
 
 		static const GLchar* fragmentShader = "\
 			precision mediump float;\
-			uniform vec4 color;\
+			uniform float opacity;\
+			varying vec3 vertexColor;\
 			void main()\
 			{\
-			  gl_FragColor = color;\
+			  gl_FragColor = vec4(vertexColor, opacity);\
 			}\
 			";
 
 		// create program
 		m_Shader = new Shader(vertexShader, fragmentShader);
 
-		m_ColorLocation = m_Shader->GetUniformLocation("color");
+		m_OpacityLocation = m_Shader->GetUniformLocation("opacity");
 		m_MVPLocation = m_Shader->GetUniformLocation("MVP");
 		m_PositionLocation = m_Shader->GetAttribLocation("position");
+		m_ColorLocation = m_Shader->GetAttribLocation("color");
+
+		glGenBuffers(1, &m_VertexBufferID);
 	}
 
 	void DebugDraw::DrawPolygon(
@@ -78,8 +100,7 @@ namespace star
 		int32 vertexCount,
 		const Color& color)
 	{
-		CreatePolygonVertices(vertices, vertexCount);
-		AddToVertexQueue(Lines, vertexCount, color);
+		AddToVertexQueue(Lines, vertices, vertexCount, color);
 	}
 
 	void DebugDraw::DrawSolidPolygon(
@@ -87,8 +108,7 @@ namespace star
 		int32 vertexCount, 
 		const Color& color)
 	{
-		CreatePolygonVertices(vertices, vertexCount);
-		AddToVertexQueue(Triangles + Lines, vertexCount, color);
+		AddToVertexQueue(Triangles + Lines, vertices, vertexCount, color);
 	}
 
 	void DebugDraw::DrawCircle(
@@ -98,7 +118,7 @@ namespace star
 		uint32 segments)
 	{
 		CreateCircleVertices(center, radius, segments);
-		AddToVertexQueue(Lines, segments, color);
+		AddToVertexQueue(Lines, &m_CircleVertices[0], segments, color);
 	}
 
 	void DebugDraw::DrawSolidCircle(
@@ -108,7 +128,7 @@ namespace star
 		uint32 segments)
 	{
 		CreateCircleVertices(center, radius, segments);
-		AddToVertexQueue(Triangles + Lines, segments, color);
+		AddToVertexQueue(Triangles + Lines, &m_CircleVertices[0], segments, color);
 	}
 
 	void DebugDraw::DrawSegment(
@@ -116,9 +136,8 @@ namespace star
 		const vec2& pos2, 
 		const Color& color)
 	{
-		m_Vertices[0] = pos1;
-		m_Vertices[1] = pos2;
-		AddToVertexQueue(Lines, 2, color);
+		const vec2 vertices[] = { pos1, pos2 };
+		AddToVertexQueue(Lines, vertices, 2, color);
 	}
 
 	void DebugDraw::DrawPoint(
@@ -127,9 +146,7 @@ namespace star
 		const Color& color)
 	{
 		m_PointSize = size;
-
-		m_Vertices[0] = pos;
-		AddToVertexQueue(Points, 1, color);
+		AddToVertexQueue(Points, &pos, 1, color);
 	}
 
 	void DebugDraw::DrawLine(
@@ -137,9 +154,8 @@ namespace star
 		const vec2& pos2, 
 		const Color& color)
 	{
-		m_Vertices[0] = pos1;
-		m_Vertices[1] = pos2;
-		AddToVertexQueue(Lines,2,color);
+		const vec2 vertices[] = { pos1, pos2 };
+		AddToVertexQueue(Lines, vertices, 2, color);
 	}
 
 	void DebugDraw::DrawString(
@@ -158,111 +174,137 @@ namespace star
 		const AARect& rect, 
 		const Color& color)
 	{
-		m_Vertices[0].x = float32(rect.GetLeft());
-		m_Vertices[0].y = float32(rect.GetBottom());
-		m_Vertices[1].x = float32(rect.GetRight());
-		m_Vertices[1].y = float32(rect.GetBottom());
-		m_Vertices[2].x = float32(rect.GetRight());
-		m_Vertices[2].y = float32(rect.GetTop());
-		m_Vertices[3].x = float32(rect.GetLeft());
-		m_Vertices[3].y = float32(rect.GetTop());
-		AddToVertexQueue(Lines, 4, color);
+		const vec2 vertices[] = 
+		{
+			vec2(rect.GetLeft(), rect.GetBottom()),
+			vec2(rect.GetRight(), rect.GetBottom()),
+			vec2(rect.GetRight(), rect.GetTop()),
+			vec2(rect.GetLeft(), rect.GetTop())
+		};
+		AddToVertexQueue(Lines, vertices, 4, color);
 	}
 
 	void DebugDraw::DrawRect(
 		const Rect& rect, 
 		const Color& color)
 	{
-		m_Vertices[0] = rect.GetLeftBottom();
-		m_Vertices[1] = rect.GetRightBottom();
-		m_Vertices[2] = rect.GetRightTop();
-		m_Vertices[3] = rect.GetLeftTop();
-		AddToVertexQueue(Lines, 4, color);
+		const vec2 vertices[] = 
+		{
+			rect.GetLeftBottom(),
+			rect.GetRightBottom(),
+			rect.GetRightTop(),
+			rect.GetLeftTop()
+		};
+		AddToVertexQueue(Lines, vertices, 4, color);
 	}
 
 	void DebugDraw::DrawSolidRect(
 		const AARect& rect, 
 		const Color& color)
 	{
-		m_Vertices[0].x = float32(rect.GetLeft());
-		m_Vertices[0].y = float32(rect.GetBottom());
-		m_Vertices[1].x = float32(rect.GetRight());
-		m_Vertices[1].y = float32(rect.GetBottom());
-		m_Vertices[2].x = float32(rect.GetRight());
-		m_Vertices[2].y = float32(rect.GetTop());
-		m_Vertices[3].x = float32(rect.GetLeft()); 
-		m_Vertices[3].y = float32(rect.GetTop());
-		AddToVertexQueue(Triangles + Lines, 4, color);
+		const vec2 vertices[] = 
+		{
+			vec2(rect.GetLeft(), rect.GetBottom()),
+			vec2(rect.GetRight(), rect.GetBottom()),
+			vec2(rect.GetRight(), rect.GetTop()),
+			vec2(rect.GetLeft(), rect.GetTop())
+		};
+		AddToVertexQueue(Triangles + Lines, vertices, 4, color);
 	}
 
 	void DebugDraw::DrawSolidRect(
 		const Rect& rect, 
 		const Color& color)
 	{
-		m_Vertices[0] = rect.GetLeftBottom();
-		m_Vertices[1] = rect.GetRightBottom();
-		m_Vertices[2] = rect.GetRightTop();
-		m_Vertices[3] = rect.GetLeftTop();
-		AddToVertexQueue(Triangles + Lines, 4, color);
-	}
-
-	void DebugDraw::CreatePolygonVertices(
-		const vec2* vertices, 
-		uint32 vertexCount)
-	{
-		ASSERT_LOG(vertexCount <= MAX_VERTICES, 
-			_T("DebugDraw::CreatePolygonVertices: \
-more vertices than allocated space"),
-			STARENGINE_LOG_TAG);
-
-		for (uint32 i = 0; i < vertexCount; ++i)
+		const vec2 vertices[] = 
 		{
-			m_Vertices[i] = vertices[i];
-		}
+			rect.GetLeftBottom(),
+			rect.GetRightBottom(),
+			rect.GetRightTop(),
+			rect.GetLeftTop()
+		};
+		AddToVertexQueue(Triangles + Lines, vertices, 4, color);
 	}
 
 	void DebugDraw::CreateCircleVertices
 		(const vec2& center, 
 		float32 radius,
-		uint8 segments)
+		uint32 segments)
 	{
-		// [TODO] Fix this bug in eclipse: 
-		// (undefined reference to 'star::DebugDraw::MAX_VERTICES')
-		//ASSERT_LOG(m_CircleSegments < MAX_VERTICES, 
-		//	_T("DebugDraw::CreateCircleVertices: You can only draw "
-		//	+ string_cast<tstring>(MAX_VERTICES) 
-		//	+ _T(" vertices per primitive")).c_str(), STARENGINE_LOG_TAG);
+		m_CircleVertices.resize(std::max<uint32>(segments, 1));
 		const float32 increment = float32(2.0 * PI / segments);
 		float32 theta = 0.0f;
 
 		for (uint32 i = 0; i < segments; ++i)
 		{
-			vec2 vec = center + radius * vec2(cos(theta), sin(theta));
-
-			m_Vertices[i] = vec;
+			m_CircleVertices[i] = center + radius * vec2(cos(theta), sin(theta));
 			theta += increment;
 		}
 	}
 
 	void DebugDraw::AddToVertexQueue(
 		uint32 primitiveTypes,
+		const vec2* vertices,
 		uint32 count,
 		const Color& color
 		)
 	{
-		PrimitiveInfo tempInfo = PrimitiveInfo();
-		for(uint32 i = 0; i < MAX_VERTICES; ++i)
+		if(count == 0)
 		{
-			tempInfo.vertices[i] = m_Vertices[i];
+			return;
 		}
-		tempInfo.primitiveType = primitiveTypes;
-		tempInfo.count = count;
-		tempInfo.color = color;
-		tempInfo.opacityLines = m_DrawOpLines;
-		tempInfo.opacityTriangles = m_DrawOpTriangles;
-		tempInfo.opacityPoints = m_DrawOpPoints;
-
-		m_VertexBuffer.push_back(tempInfo);
+		++m_PrimitiveCount;
+
+		DebugVertex colorVertex;
+		colorVertex.r = uint8(Clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+		colorVertex.g = uint8(Clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+		colorVertex.b = uint8(Clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+		colorVertex.a = 255;
+
+		if((primitiveTypes & Triangles) != 0)
+		{
+			//Triangle fan to triangle list
+			for(uint32 i = 2; i < count; ++i)
+			{
+				PushVertex(m_TriangleVertices, vertices[0], colorVertex);
+				PushVertex(m_TriangleVertices, vertices[i - 1], colorVertex);
+				PushVertex(m_TriangleVertices, vertices[i], colorVertex);
+			}
+		}
+
+		if((primitiveTypes & Lines) != 0)
+		{
+			//Line loop to line list, a single segment isn't closed
+			for(uint32 i = 1; i < count; ++i)
+			{
+				PushVertex(m_LineVertices, vertices[i - 1], colorVertex);
+				PushVertex(m_LineVertices, vertices[i], colorVertex);
+			}
+			if(count > 2)
+			{
+				PushVertex(m_LineVertices, vertices[count - 1], colorVertex);
+				PushVertex(m_LineVertices, vertices[0], colorVertex);
+			}
+		}
+
+		if((primitiveTypes & Points) != 0)
+		{
+			for(uint32 i = 0; i < count; ++i)
+			{
+				PushVertex(m_PointVertices, vertices[i], colorVertex);
+			}
+		}
+	}
+
+	void DebugDraw::PushVertex(
+		std::vector<DebugVertex>& stream,
+		const vec2& position,
+		const DebugVertex& colorVertex
+		)
+	{
+		DebugVertex vertex(colorVertex);
+		vertex.position = position;
+		stream.push_back(vertex);
 	}
 
 	void DebugDraw::Begin()
@@ -285,44 +327,91 @@ more vertices than allocated space"),
 	void DebugDraw::Flush()
 	{
 #ifdef DESKTOP
-		Begin();
-
-		for(const auto & elem : m_VertexBuffer)
+		if(m_PrimitiveCount > 0)
 		{
-			glEnableVertexAttribArray(m_PositionLocation);
-			glVertexAttribPointer(m_PositionLocation, 2, GL_FLOAT, 
-				GL_FALSE, 0, elem.vertices);
+			Begin();
+			UploadVertices();
+
+			uint32 first(0);
+			DrawStream(GL_TRIANGLES, first, m_TriangleVertices.size(), m_DrawOpTriangles);
+			first += m_TriangleVertices.size();
+			DrawStream(GL_LINES, first, m_LineVertices.size(), m_DrawOpLines);
+			first += m_LineVertices.size();
+			//[TODO] only works for windows..
+			glPointSize(m_PointSize);
+			DrawStream(GL_POINTS, first, m_PointVertices.size(), m_DrawOpPoints);
+		}
+#endif
+		End();
+	}
 
-			if ((elem.primitiveType & Triangles) != 0)
-			{
-				glUniform4f(m_ColorLocation, elem.color.r, elem.color.g, elem.color.b, m_DrawOpTriangles);
-				glDrawArrays(GL_TRIANGLE_FAN, 0, elem.count);
-			}
+	void DebugDraw::UploadVertices()
+	{
+		const uint32 vertexSize = sizeof(DebugVertex);
+		const uint32 triangleSize = m_TriangleVertices.size() * vertexSize;
+		const uint32 lineSize = m_LineVertices.size() * vertexSize;
+		const uint32 pointSize = m_PointVertices.size() * vertexSize;
+		const uint32 totalSize = triangleSize + lineSize + pointSize;
+
+		GLStateCache::GetInstance()->BindBuffer(GL_ARRAY_BUFFER, m_VertexBufferID);
+		if(totalSize > m_VertexBufferSize)
+		{
+			m_VertexBufferSize = totalSize + totalSize / 2;
+		}
+		//Orphan last frame's storage, then fill it stream by stream
+		glBufferData(GL_ARRAY_BUFFER, m_VertexBufferSize, nullptr, GL_STREAM_DRAW);
+		if(triangleSize > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, 0, triangleSize, &m_TriangleVertices[0]);
+		}
+		if(lineSize > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, triangleSize, lineSize, &m_LineVertices[0]);
+		}
+		if(pointSize > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, triangleSize + lineSize,
+				pointSize, &m_PointVertices[0]);
+		}
 
-			if ((elem.primitiveType & Lines) != 0)
-			{
-				glUniform4f(m_ColorLocation, elem.color.r, elem.color.g, elem.color.b, m_DrawOpLines);
-				glDrawArrays(GL_LINE_LOOP, 0, elem.count);
-			}
+		const GLuint attributes[] = { m_PositionLocation, m_ColorLocation };
+		GLStateCache::GetInstance()->SetEnabledVertexAttribArrays(
+			GLStateCache::CreateVertexAttribMask(attributes, 2));
+		glVertexAttribPointer(m_PositionLocation, 2, GL_FLOAT, GL_FALSE, vertexSize,
+			reinterpret_cast<const GLvoid*>(offsetof(DebugVertex, position)));
+		glVertexAttribPointer(m_ColorLocation, 3, GL_UNSIGNED_BYTE, GL_TRUE, vertexSize,
+			reinterpret_cast<const GLvoid*>(offsetof(DebugVertex, r)));
+
+		RenderStats & stats = GraphicsManager::GetInstance()->GetCurrentRenderStats();
+		++stats.bufferUploads;
+		stats.bytesUploaded += totalSize;
+	}
 
-			if ((elem.primitiveType & Points) != 0)
-			{
-				glUniform4f(m_ColorLocation, elem.color.r, elem.color.g, elem.color.b, m_DrawOpPoints);
-				//[TODO] only works for windows..
-				glPointSize(m_PointSize);
-				glDrawArrays(GL_POINTS, 0, elem.count);
-			}
-			glDisableVertexAttribArray(m_PositionLocation);
+	void DebugDraw::DrawStream(
+		GLenum mode,
+		uint32 first,
+		uint32 count,
+		float32 opacity
+		)
+	{
+		if(count == 0)
+		{
+			return;
 		}
-
-		End();
-#endif
+		glUniform1f(m_OpacityLocation, opacity);
+		glDrawArrays(mode, first, count);
+		++GraphicsManager::GetInstance()->GetCurrentRenderStats().drawCalls;
 	}
 
 	void DebugDraw::End()
 	{
-		m_Shader->Unbind();
-		m_VertexBuffer.clear();
+		GraphicsManager::GetInstance()->GetCurrentRenderStats().debugPrimitives +=
+			m_PrimitiveCount;
+
+		m_TriangleVertices.clear();
+		m_LineVertices.clear();
+		m_PointVertices.clear();
+		m_PrimitiveCount = 0;
 	}
 
 }
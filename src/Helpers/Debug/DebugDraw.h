@@ -16,30 +16,12 @@ namespace star
 	class AARect;
 	class Rect;
 
-	struct PrimitiveInfo
+	//Vertex of the debug primitive streams (12 bytes)
+	struct DebugVertex
 	{
-		PrimitiveInfo()
-			: primitiveType(0)
-			, count(0)
-			, color()
-			, opacityTriangles(0)
-			, opacityLines(0)
-			, opacityPoints(0)
-		{
-			//Don't initialize the array's elements to vec2(), 
-			//not necessairy in this case.
-		}
-	private:
-		static const uint32 MAX_VERTICES = 64;
-
-	public:
-		vec2 vertices[MAX_VERTICES];
-		uint32 primitiveType;
-		uint32 count;
-		Color color;
-		float32	  opacityTriangles
-				, opacityLines
-				, opacityPoints;
+		vec2 position;
+		//RGB8 color, the opacity is set per primitive type
+		uint8 r, g, b, a;
 	};
 
 	class DebugDraw final : public Singleton<DebugDraw>
@@ -117,8 +99,6 @@ namespace star
 		void Flush();
   
 	private:
-		static const uint32 MAX_VERTICES = 64;
-
 		enum
 		{
 			Triangles = 0x01,
@@ -129,26 +109,43 @@ namespace star
 		DebugDraw();
 		~DebugDraw();
 		
-		void CreatePolygonVertices(
-			const vec2* vertices, 
-			uint32 vertexCount
-			);  
 		void CreateCircleVertices(
 			const vec2& center, 
 			float32 radius,
-			uint8 segments
+			uint32 segments
 			);  
 		void AddToVertexQueue(
 			uint32 primitiveTypes,
+			const vec2* vertices,
 			uint32 count, 
 			const Color& color
 			);
+		static void PushVertex(
+			std::vector<DebugVertex>& stream,
+			const vec2& position,
+			const DebugVertex& colorVertex
+			);
 		
 		void Begin();
+		void UploadVertices();
+		void DrawStream(
+			GLenum mode,
+			uint32 first,
+			uint32 count,
+			float32 opacity
+			);
 		void End();
 
-		std::vector<PrimitiveInfo> m_VertexBuffer;
-		vec2 m_Vertices[MAX_VERTICES];
+		//Every primitive is converted to a triangle list, a line list or points.
+		//The three streams are uploaded as one buffer and drawn in a call each.
+		std::vector<DebugVertex> m_TriangleVertices,
+								 m_LineVertices,
+								 m_PointVertices;
+		//Scratch buffer for the generated circle vertices
+		std::vector<vec2> m_CircleVertices;
+		uint32 m_PrimitiveCount;
+		GLuint m_VertexBufferID;
+		uint32 m_VertexBufferSize;
 		float32 m_PointSize;  
 
 		float32 m_DrawOpTriangles;
@@ -156,9 +153,10 @@ namespace star
 		float32 m_DrawOpPoints;
 
 		Shader* m_Shader;
-		GLuint m_ColorLocation;  
+		GLuint m_OpacityLocation;  
 		GLuint m_MVPLocation;
 		GLuint m_PositionLocation;  	
+		GLuint m_ColorLocation;
 
 		DebugDraw(const DebugDraw &);
 		DebugDraw(DebugDraw &&);
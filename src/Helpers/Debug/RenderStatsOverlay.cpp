@@ -0,0 +1,67 @@
+#include "RenderStatsOverlay.h"
+#include "../../Context.h"
+#include "../../StarEngine.h"
+#include "../../Graphics/GraphicsManager.h"
+#include "../../Components/Graphics/TextComponent.h"
+#include "../Helpers.h"
+
+namespace star
+{
+	RenderStatsOverlay::RenderStatsOverlay(
+		const tstring & fontPath,
+		const tstring & fontName,
+		uint32 fontSize
+		)
+		: Object(_T("RenderStatsOverlay"))
+		, m_pText(nullptr)
+		, m_RefreshTime(0.5)
+		, m_Timer(0)
+	{
+		m_pText = new TextComponent(fontPath, fontName, fontSize);
+		m_pText->SetHUDOptionEnabled(true);
+		AddComponent(m_pText);
+	}
+
+	RenderStatsOverlay::~RenderStatsOverlay()
+	{
+	}
+
+	void RenderStatsOverlay::SetRefreshTime(float64 seconds)
+	{
+		m_RefreshTime = seconds;
+	}
+
+	void RenderStatsOverlay::Update(const Context & context)
+	{
+		m_Timer -= context.time->DeltaTime().GetSeconds();
+		if(m_Timer <= 0)
+		{
+			m_Timer = m_RefreshTime;
+			UpdateText();
+		}
+	}
+
+	void RenderStatsOverlay::UpdateText()
+	{
+		const RenderStats & stats = GraphicsManager::GetInstance()->GetRenderStats();
+		m_pText->SetText(
+			_T("FPS: ") + string_cast<tstring>(StarEngine::GetInstance()->GetPreviousFPS()) +
+			_T("\nDraw calls: ") + string_cast<tstring>(stats.drawCalls) +
+			_T("\nTexture binds: ") + string_cast<tstring>(stats.textureBinds) +
+			_T("\nSprites: ") + string_cast<tstring>(stats.sprites) +
+			_T("\nGlyphs: ") + string_cast<tstring>(stats.glyphs) +
+			_T("\nQuad batches: ") + string_cast<tstring>(stats.quadBatches) +
+			_T("\nDebug primitives: ") + string_cast<tstring>(stats.debugPrimitives) +
+			_T("\nUploaded: ") + string_cast<tstring>(stats.bufferUploads) +
+			_T(" buffers, ") + string_cast<tstring>(uint32(stats.bytesUploaded / 1024)) +
+			_T(" KB") +
+			_T("\nState changes: ") + string_cast<tstring>(stats.stateChanges) +
+			_T(", skipped: ") + string_cast<tstring>(stats.redundantStateChanges)
+			);
+	}
+
+	CullingBoundsType RenderStatsOverlay::GetCullingBounds(vec4 & bounds) const
+	{
+		return GetContentCullingBounds(bounds);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../defines.h"
+#include "../../Objects/Object.h"
+
+namespace star
+{
+	class TextComponent;
+
+	//[NOTE]	HUD text showing the RenderStats of the last frame.
+	//			Add it to a scene like any other object,
+	//			and move it with its TransformComponent.
+	class RenderStatsOverlay : public Object
+	{
+	public:
+		RenderStatsOverlay(
+			const tstring & fontPath,
+			const tstring & fontName,
+			uint32 fontSize
+			);
+		virtual ~RenderStatsOverlay();
+
+		//Time in seconds between two text updates, 
+		//so the text stays readable and doesn't add glyph work every frame.
+		void SetRefreshTime(float64 seconds);
+
+		//Culled by its text like any other object
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+
+	protected:
+		virtual void Update(const Context & context);
+
+	private:
+		void UpdateText();
+
+		TextComponent * m_pText;
+		float64 m_RefreshTime,
+				m_Timer;
+
+		RenderStatsOverlay(const RenderStatsOverlay &);
+		RenderStatsOverlay(RenderStatsOverlay &&);
+		RenderStatsOverlay & operator=(const RenderStatsOverlay &);
+		RenderStatsOverlay & operator=(RenderStatsOverlay&&);
+	};
+}
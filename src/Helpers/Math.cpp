@@ -799,6 +799,78 @@ namespace star
 		GetRotationAndScaling(matrix, rotation, scaling);
 	}
 
+	mat4 InterpolateAffine2D(const mat4 & start, const mat4 & end,
+		const vec2 & pivot, float32 percent)
+	{
+		//The xy part of both as rotation * | scaleX shear  |
+		//                                   | 0      scaleY |
+		//mirroring ends up as a negative scaleY.
+		const mat4 * matrices[2] = { &start, &end };
+		float32 angles[2], scalesX[2], scalesY[2], shears[2];
+		for(int32 i = 0; i < 2; ++i)
+		{
+			const mat4 & matrix = *matrices[i];
+			scalesX[i] = sqrt(matrix[0][0] * matrix[0][0] + matrix[0][1] * matrix[0][1]);
+			if(scalesX[i] > 0)
+			{
+				float32 cosine = matrix[0][0] / scalesX[i];
+				float32 sine = matrix[0][1] / scalesX[i];
+				angles[i] = atan2(sine, cosine);
+				shears[i] = cosine * matrix[1][0] + sine * matrix[1][1];
+				scalesY[i] = cosine * matrix[1][1] - sine * matrix[1][0];
+			}
+			else
+			{
+				angles[i] = 0;
+				shears[i] = matrix[1][0];
+				scalesY[i] = matrix[1][1];
+			}
+		}
+
+		//A mirror that flips during the step can't be blended
+		if((scalesY[0] < 0) != (scalesY[1] < 0))
+		{
+			return end;
+		}
+
+		//Turn the short way around
+		float32 turn = angles[1] - angles[0];
+		if(turn > float32(PI))
+		{
+			turn -= float32(2 * PI);
+		}
+		else if(turn < float32(-PI))
+		{
+			turn += float32(2 * PI);
+		}
+		float32 angle = angles[0] + turn * percent;
+		float32 scaleX = Lerp(scalesX[0], scalesX[1], percent);
+		float32 scaleY = Lerp(scalesY[0], scalesY[1], percent);
+		float32 shear = Lerp(shears[0], shears[1], percent);
+		float32 cosine = cos(angle);
+		float32 sine = sin(angle);
+
+		mat4 result(end);
+		result[0][0] = scaleX * cosine;
+		result[0][1] = scaleX * sine;
+		result[1][0] = shear * cosine - scaleY * sine;
+		result[1][1] = shear * sine + scaleY * cosine;
+
+		vec2 pivotStart(
+			start[0][0] * pivot.x + start[1][0] * pivot.y + start[3][0],
+			start[0][1] * pivot.x + start[1][1] * pivot.y + start[3][1]
+			);
+		vec2 pivotEnd(
+			end[0][0] * pivot.x + end[1][0] * pivot.y + end[3][0],
+			end[0][1] * pivot.x + end[1][1] * pivot.y + end[3][1]
+			);
+		vec2 pivotWorld = Lerp(pivotStart, pivotEnd, percent);
+		result[3][0] = pivotWorld.x - (result[0][0] * pivot.x + result[1][0] * pivot.y);
+		result[3][1] = pivotWorld.y - (result[0][1] * pivot.x + result[1][1] * pivot.y);
+		result[3][2] = Lerp(start[3][2], end[3][2], percent);
+		return result;
+	}
+
 	int32 GenerateRandomNumber(int32 min, int32 max)
 	{
 		if(min == max)
@@ -186,6 +186,11 @@ namespace star
 	void GetRotationAndScaling(const mat4& matrix, float32 & rotation, vec2 & scaling);
 	void DecomposeMatrix(const mat4& matrix, pos & position,
 		vec2 & scaling, float32 & rotation);
+	//Blends the rotation around z, scale and shear of two affine matrices
+	//separately instead of every element, so a turning quad keeps its size.
+	//The local pivot moves in a straight line, z is blended linearly.
+	mat4 InterpolateAffine2D(const mat4 & start, const mat4 & end,
+		const vec2 & pivot, float32 percent);
 
 	int32 GenerateRandomNumber(int32 min, int32 max);
 	uint32 GenerateRandomNumber(uint32 min, uint32 max);
@@ -48,4 +48,9 @@ namespace star
 	{
 		GetComponent<CameraComponent>()->ConvertScreenToWorld(posInOut);
 	}
+
+	CullingBoundsType BaseCamera::GetCullingBounds(vec4 & bounds) const
+	{
+		return GetContentCullingBounds(bounds);
+	}
 }
@@ -20,6 +20,9 @@ namespace star
 
 		void ConvertScreenToWorld(vec2 & posInOut);
 
+		//Cameras draw nothing themselves, only their children are culled
+		CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+
 	protected:
 		virtual void Initialize();
 		CameraComponent *m_pCamera;
@@ -19,12 +19,15 @@ namespace star
 		, m_pScene(nullptr)
 		, m_pGarbageContainer()
 		, m_pComponents()
+		, m_pComponentSlots()
 		, m_pChildren()
 		, m_pActions()
 		, m_GroupTag(_T("Default"))
 		, m_PhysicsTag(_T("Default"))
 	{
-		m_pComponents.push_back(new TransformComponent(this));
+		auto transform = new TransformComponent(this);
+		m_pComponents.push_back(transform);
+		SetComponentSlot(transform);
 	}
 
 	Object::Object(const tstring & name)
@@ -37,12 +40,15 @@ namespace star
 		, m_pScene(nullptr)
 		, m_pGarbageContainer()
 		, m_pComponents()
+		, m_pComponentSlots()
 		, m_pChildren()
 		, m_pActions()
 		, m_GroupTag(_T("Default"))
 		, m_PhysicsTag(_T("Default"))
 	{
-		m_pComponents.push_back(new TransformComponent(this));
+		auto transform = new TransformComponent(this);
+		m_pComponents.push_back(transform);
+		SetComponentSlot(transform);
 	}
 
 	Object::Object(
@@ -58,12 +64,15 @@ namespace star
 		, m_pScene(nullptr)
 		, m_pGarbageContainer()
 		, m_pComponents()
+		, m_pComponentSlots()
 		, m_pChildren()
 		, m_pActions()
 		, m_GroupTag(groupTag)
 		, m_PhysicsTag(_T("Default"))
 	{
-		m_pComponents.push_back(new TransformComponent(this));
+		auto transform = new TransformComponent(this);
+		m_pComponents.push_back(transform);
+		SetComponentSlot(transform);
 	}
 
 	Object::~Object(void)
@@ -79,6 +88,7 @@ namespace star
 			SafeDelete(comp);
 		}
 		m_pComponents.clear();
+		m_pComponentSlots.clear();
 
 		for(auto child : m_pChildren)
 		{
@@ -171,6 +181,7 @@ namespace star
 				auto object = dynamic_cast<Object*>(info.element);
 				auto it = std::find(m_pChildren.begin(), m_pChildren.end(), object);
 				m_pChildren.erase(it);
+				MarkCullingBoundsDirty();
 			}
 			break;
 			case GarbageType::ComponentType:
@@ -178,7 +189,9 @@ namespace star
 				auto component = dynamic_cast<BaseComponent*>(info.element);
 				auto it = std::find(m_pComponents.begin(), m_pComponents.end(), component);
 				m_pComponents.erase(it);
+				ClearComponentSlot(component);
 				RecalculateDimensions();
+				MarkCullingBoundsDirty();
 			}
 			break;
 		}
@@ -325,6 +338,73 @@ namespace star
 		return false;
 	}
 
+	CullingBoundsType Object::GetCullingBounds(vec4 & bounds) const
+	{
+		//Only a plain Object is known to keep the CheckCulling above
+		if(typeid(*this) != typeid(Object))
+		{
+			return CullingBoundsType::Unbounded;
+		}
+		return GetContentCullingBounds(bounds);
+	}
+
+	CullingBoundsType Object::GetContentCullingBounds(vec4 & bounds) const
+	{
+		//Union of everything that can pass BaseCheckCulling,
+		//children are checked even if their parent is culled.
+		CullingBoundsType type(CullingBoundsType::None);
+		auto merge = [&](CullingBoundsType otherType, const vec4 & other) -> bool
+		{
+			if(otherType == CullingBoundsType::Bounds)
+			{
+				if(type == CullingBoundsType::None)
+				{
+					bounds = other;
+				}
+				else
+				{
+					bounds.x = std::min(bounds.x, other.x);
+					bounds.y = std::min(bounds.y, other.y);
+					bounds.z = std::max(bounds.z, other.z);
+					bounds.w = std::max(bounds.w, other.w);
+				}
+				type = CullingBoundsType::Bounds;
+			}
+			return otherType != CullingBoundsType::Unbounded;
+		};
+
+		vec4 other;
+		for(auto component : m_pComponents)
+		{
+			if(component && !merge(component->GetCullingBounds(other), other))
+			{
+				return CullingBoundsType::Unbounded;
+			}
+		}
+		for(auto child : m_pChildren)
+		{
+			if(child && !merge(child->GetCullingBounds(other), other))
+			{
+				return CullingBoundsType::Unbounded;
+			}
+		}
+		return type;
+	}
+
+	void Object::MarkCullingBoundsDirty()
+	{
+		//Only top level objects are stored in the spatial index
+		Object * pRoot(this);
+		while(pRoot->m_pParentGameObject != nullptr)
+		{
+			pRoot = pRoot->m_pParentGameObject;
+		}
+		if(pRoot->m_pScene != nullptr)
+		{
+			pRoot->m_pScene->MarkCullingBoundsDirty(pRoot);
+		}
+	}
+
 	void Object::BaseDraw()
 	{
 		if(m_IsVisible)
@@ -443,13 +523,12 @@ namespace star
 
 	void Object::AddComponent(BaseComponent *pComponent)
 	{
-		for(auto comp : m_pComponents)
-		{
-			ASSERT_LOG(typeid(*comp) != typeid(*pComponent), 
-				_T("Object::AddComponent: \
+		uint32 typeID = ComponentTypeID::Get(pComponent);
+		ASSERT_LOG(typeID >= m_pComponentSlots.size()
+			|| m_pComponentSlots[typeID] == nullptr, 
+			_T("Object::AddComponent: \
 Adding 2 components of the same type \
 to the same object is illegal."), STARENGINE_LOG_TAG);
-		}
 
 		pComponent->SetParent(this);
 
@@ -459,6 +538,8 @@ to the same object is illegal."), STARENGINE_LOG_TAG);
 		}
 
 		m_pComponents.push_back(pComponent);
+		SetComponentSlot(pComponent);
+		MarkCullingBoundsDirty();
 	}	
 
 	void Object::AddChild(Object *pChild)
@@ -481,6 +562,7 @@ Child gets added but beware, duplicate names can become the cause of problems.")
 		}
 
 		m_pChildren.push_back(pChild);
+		MarkCullingBoundsDirty();
 	}
 
 	void Object::RemoveChild(const Object* pObject)
@@ -824,6 +906,30 @@ to remove could not be found."), STARENGINE_LOG_TAG);
 		return m_pComponents;
 	}
 
+	void Object::SetComponentSlot(BaseComponent* pComponent)
+	{
+		uint32 typeID = ComponentTypeID::Get(pComponent);
+		if(typeID >= m_pComponentSlots.size())
+		{
+			m_pComponentSlots.resize(typeID + 1, nullptr);
+		}
+		//Like before, the first component of a type is the one that is found
+		if(m_pComponentSlots[typeID] == nullptr)
+		{
+			m_pComponentSlots[typeID] = pComponent;
+		}
+	}
+
+	void Object::ClearComponentSlot(BaseComponent* pComponent)
+	{
+		uint32 typeID = ComponentTypeID::Get(pComponent);
+		if(typeID < m_pComponentSlots.size()
+			&& m_pComponentSlots[typeID] == pComponent)
+		{
+			m_pComponentSlots[typeID] = nullptr;
+		}
+	}
+
 	void Object::CollectGarbage()
 	{
 		for(auto & info : m_pGarbageContainer)
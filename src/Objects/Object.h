@@ -5,6 +5,7 @@
 #include "../Logger.h"
 #include "../Context.h"
 #include "../Components/TransformComponent.h"
+#include "../Components/ComponentTypeID.h"
 #include "../AI/Pathfinding/PathFindManager.h"
 #include "../Helpers/HashTag.h"
 #include "../Graphics/Color.h"
@@ -120,6 +121,17 @@ namespace star
 
 		void RecalculateDimensions();
 
+		//Bounds of this object and all of its children, used by the
+		//spatial index of the scene. Subclasses are unbounded by default,
+		//as their CheckCulling isn't known here, so they're always checked.
+		//Subclasses that keep the default CheckCulling opt in with:
+		//	CullingBoundsType GetCullingBounds(vec4 & bounds) const
+		//	{ return GetContentCullingBounds(bounds); }
+		//UIObject, BaseCamera, UIBaseCursor and RenderStatsOverlay do.
+		virtual CullingBoundsType GetCullingBounds(vec4 & bounds) const;
+		//Lets the scene know the bounds have to be recalculated
+		void MarkCullingBoundsDirty();
+
 	protected:
 		enum class GarbageType : byte
 		{
@@ -156,6 +168,8 @@ namespace star
 			float32 top,
 			float32 bottom
 			);
+		//Union of the bounds of the components and children
+		CullingBoundsType GetContentCullingBounds(vec4 & bounds) const;
 
 		bool m_bIsInitialized;
 		bool m_IsVisible;
@@ -167,6 +181,8 @@ namespace star
 		std::vector<GarbageInfo> m_pGarbageContainer;
 
 		std::vector<BaseComponent*> m_pComponents;
+		//Indexed by ComponentTypeID, nullptr for types this object doesn't have
+		std::vector<BaseComponent*> m_pComponentSlots;
 		std::vector<Object*> m_pChildren;
 		std::vector<Action*> m_pActions;
 
@@ -174,6 +190,8 @@ namespace star
 
 	private:
 		void CollectGarbage();
+		void SetComponentSlot(BaseComponent* pComponent);
+		void ClearComponentSlot(BaseComponent* pComponent);
 
 		Object(const Object& t);
 		Object(Object&& t);
@@ -35,38 +35,39 @@ Trying to get unknown child '")
 	template <typename T>
 	void Object::RemoveComponent()
 	{
-		const std::type_info& ti = typeid(T);
-		for(auto component : m_pComponents)
+		uint32 typeID = ComponentTypeID::Get<T>();
+		if(typeID < m_pComponentSlots.size()
+			&& m_pComponentSlots[typeID] != nullptr)
 		{
-			if(component && typeid(*component) == ti)
-			{
-				m_pGarbageContainer.push_back(
-					GarbageInfo(
-						component,
-						GarbageType::ComponentType
-						)
-					);
-			}
-		}	
+			m_pGarbageContainer.push_back(
+				GarbageInfo(
+					m_pComponentSlots[typeID],
+					GarbageType::ComponentType
+					)
+				);
+		}
 	}
 
 	template <typename T>
 	T* Object::GetComponent(bool searchChildren) const
 	{
-		const std::type_info& ti = typeid(T);
-		for(auto component : m_pComponents)
+		//The slot only holds components of exactly this type
+		uint32 typeID = ComponentTypeID::Get<T>();
+		if(typeID < m_pComponentSlots.size()
+			&& m_pComponentSlots[typeID] != nullptr)
 		{
-			if(component && typeid(*component) == ti)
-			{
-				return dynamic_cast<T*>(component);
-			}
+			return static_cast<T*>(m_pComponentSlots[typeID]);
 		}
 
 		if(searchChildren)
 		{
 			for(auto child : m_pChildren)
 			{
-				return (child->GetComponent<T>(searchChildren));
+				T* component = child->GetComponent<T>(searchChildren);
+				if(component != nullptr)
+				{
+					return component;
+				}
 			}
 		}
 		return nullptr;
@@ -105,15 +106,9 @@ Trying to get unknown child '")
 	template <typename T>
 	bool Object::HasComponent(BaseComponent * component) const
 	{
-		const std::type_info& ti = typeid(T);
-		for(auto comp : m_pComponents)
-		{
-			if(comp != component &&
-				typeid(*comp) == ti)
-			{
-				return true;
-			}
-		}
-		return false;
+		uint32 typeID = ComponentTypeID::Get<T>();
+		return typeID < m_pComponentSlots.size()
+			&& m_pComponentSlots[typeID] != nullptr
+			&& m_pComponentSlots[typeID] != component;
 	}
 }
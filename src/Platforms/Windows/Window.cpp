@@ -356,7 +356,6 @@ namespace star
 			{
 				if(m_IsActive)
 				{
-					star::InputManager::GetInstance()->UpdateWin();
 					mGamePtr->Update(mContext);
 					SetWindowsTitle();
 					GraphicsManager::GetInstance()->SetHasWindowChanged(false);
@@ -365,6 +364,11 @@ namespace star
 					SwapBuffers(Window::mHDC); // Swaps display buffers
 					TimeManager::GetInstance()->StopMonitoring();
 				}
+				else
+				{
+					//Nothing to update, don't spin until the next message
+					WaitMessage();
+				}
 			}
 		}
 	}
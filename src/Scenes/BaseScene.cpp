@@ -17,6 +17,7 @@
 namespace star 
 {
 	bool BaseScene::CULLING_IS_ENABLED = true;
+	const float32 BaseScene::DEFAULT_CULLING_CELL_SIZE = 256.0f;
 
 	BaseScene::BaseScene(const tstring & name)
 		: Entity(name)
@@ -29,6 +30,8 @@ namespace star
 		, m_pCursor(nullptr)
 		, m_CullingOffsetX(0)
 		, m_CullingOffsetY(0)
+		, m_CullingGrid(DEFAULT_CULLING_CELL_SIZE)
+		, m_pVisibleObjects()
 		, m_Initialized(false)
 		, m_CursorIsHidden(false)
 		, m_SystemCursorIsHidden(false)
@@ -137,6 +140,8 @@ namespace star
 
 	void BaseScene::BaseDraw()
 	{
+		DrawLayers();
+
 		if(!CULLING_IS_ENABLED)
 		{
 			for(auto pObject : m_pObjects)
@@ -146,17 +151,14 @@ namespace star
 		}
 		else
 		{
-			pos camPos = m_pDefaultCamera->GetTransform()->GetWorldPosition();
-
-			int32 screenWidth = GraphicsManager::GetInstance()->GetScreenWidth();
-			int32 screenHeight = GraphicsManager::GetInstance()->GetScreenHeight();
+			float32 left, right, top, bottom;
+			GetCullingBounds(left, right, top, bottom);
 
-			float32 left = camPos.pos2D().x - m_CullingOffsetX;
-			float32 right = camPos.pos2D().x + screenWidth + m_CullingOffsetX;
-			float32 top = camPos.pos2D().y + screenHeight + m_CullingOffsetY;
-			float32 bottom = camPos.pos2D().y - m_CullingOffsetY;
-
-			for(auto pObject : m_pObjects)
+			//Only visit the objects that can be in view
+			m_CullingGrid.Update();
+			m_pVisibleObjects.clear();
+			m_CullingGrid.Query(left, right, top, bottom, m_pVisibleObjects);
+			for(auto pObject : m_pVisibleObjects)
 			{
 				pObject->BaseDrawWithCulling(left, right, top, bottom);
 			}
@@ -225,6 +227,7 @@ Object gets added but beware, duplicate names can become the cause of problems."
 			}
 			m_pObjects.push_back(pObject);
 			pObject->SetScene(this);
+			m_CullingGrid.Add(pObject);
 		}
 		else
 		{
@@ -246,6 +249,28 @@ Object gets added but beware, duplicate names can become the cause of problems."
 		AddObject(pObject);
 	}
 
+	void BaseScene::AddObjects(const std::vector<Object*> & objects)
+	{
+		m_pObjects.reserve(m_pObjects.size() + objects.size());
+		for(auto pObject : objects)
+		{
+			if(!pObject)
+			{
+				LOG(LogLevel::Error,
+					_T("BaseScene::AddObjects: Trying to add a nullptr object."),
+					STARENGINE_LOG_TAG);
+				continue;
+			}
+			if(m_Initialized)
+			{
+				pObject->BaseInitialize();
+			}
+			m_pObjects.push_back(pObject);
+			pObject->SetScene(this);
+			m_CullingGrid.Add(pObject);
+		}
+	}
+
 	void BaseScene::RemoveObject(Object * pObject)
 	{
 		auto it = std::find(m_pObjects.begin(), m_pObjects.end(), pObject);
@@ -558,6 +583,20 @@ the custom cursor code in your game project."), STARENGINE_LOG_TAG);
 		return m_pCollisionManager;
 	}
 
+	void BaseScene::GetCullingBounds(float32 & left, float32 & right,
+		float32 & top, float32 & bottom)
+	{
+		pos camPos = m_pDefaultCamera->GetTransform()->GetWorldPosition();
+
+		int32 screenWidth = GraphicsManager::GetInstance()->GetScreenWidth();
+		int32 screenHeight = GraphicsManager::GetInstance()->GetScreenHeight();
+
+		left = camPos.pos2D().x - m_CullingOffsetX;
+		right = camPos.pos2D().x + screenWidth + m_CullingOffsetX;
+		top = camPos.pos2D().y + screenHeight + m_CullingOffsetY;
+		bottom = camPos.pos2D().y - m_CullingOffsetY;
+	}
+
 	void BaseScene::SetCullingOffset(int32 offset)
 	{
 		m_CullingOffsetX = offset;
@@ -570,6 +609,21 @@ the custom cursor code in your game project."), STARENGINE_LOG_TAG);
 		m_CullingOffsetY = offsetY;
 	}
 
+	void BaseScene::SetCullingCellSize(float32 cellSize)
+	{
+		m_CullingGrid.SetCellSize(cellSize);
+	}
+
+	void BaseScene::MarkCullingBoundsDirty(Object * pObject)
+	{
+		m_CullingGrid.MarkDirty(pObject);
+	}
+
+	void BaseScene::DrawLayers()
+	{
+
+	}
+
 	void BaseScene::CollectGarbage()
 	{
 		for(auto pElement : m_pGarbage)
@@ -579,6 +633,7 @@ the custom cursor code in your game project."), STARENGINE_LOG_TAG);
 				_T("BaseScene::CollectGarbage: Trying to delete unknown object"),
 				STARENGINE_LOG_TAG);
 			(*it)->UnsetScene();
+			m_CullingGrid.Remove(pElement);
 			m_pObjects.erase(it);
 			delete pElement;
 		}
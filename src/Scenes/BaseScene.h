@@ -6,6 +6,7 @@
 #include "../Helpers/Stopwatch.h"
 #include "../Objects/Object.h"
 #include "../Input/Gestures/GestureManager.h"
+#include "SpatialGrid.h"
 
 #include <vector>
 #include <memory>
@@ -42,6 +43,9 @@ namespace star
 
 		virtual void AddObject(Object * pObject); 
 		void AddObject(Object * pObject, const tstring & name); 
+		//Bulk version of AddObject for freshly created objects,
+		//skips the duplicate and name checks.
+		void AddObjects(const std::vector<Object*> & objects);
 		virtual void RemoveObject(Object * pObject);
 		void RemoveObject(const tstring & name);
 
@@ -86,6 +90,12 @@ namespace star
 		void SetCullingOffset(int32 offset);
 		void SetCullingOffset(int32 offsetX, int32 offsetY);
 
+		//Size of the cells of the spatial index used for culling,
+		//in world units. Best around the size of the larger sprites.
+		void SetCullingCellSize(float32 cellSize);
+		//Called by an object when its culling bounds might have changed
+		void MarkCullingBoundsDirty(Object * pObject);
+
 		std::shared_ptr<TimerManager> GetTimerManager() const;
 
 		std::shared_ptr<GestureManager> GetGestureManager() const;
@@ -100,6 +110,8 @@ namespace star
 		virtual void Draw() = 0;
 
 		void SetOSCursorHidden(bool hidden);
+		void GetCullingBounds(float32 & left, float32 & right,
+			float32 & top, float32 & bottom);
 
 		std::shared_ptr<GestureManager> m_pGestureManager;
 		std::shared_ptr<CollisionManager> m_pCollisionManager;
@@ -112,11 +124,18 @@ namespace star
 
 	private:
 		void CollectGarbage();
+		//Engine drawn content of derived scenes, like tile layers.
+		//Runs before the objects and Draw, whether or not Draw is overridden.
+		virtual void DrawLayers();
 
 		int32 m_CullingOffsetX,
 			m_CullingOffsetY;
+		SpatialGrid m_CullingGrid;
+		//Objects near the camera, filled every draw
+		std::vector<Object*> m_pVisibleObjects;
 		bool m_Initialized;
 		static bool CULLING_IS_ENABLED;
+		static const float32 DEFAULT_CULLING_CELL_SIZE;
 		bool m_CursorIsHidden, m_SystemCursorIsHidden;
 		uint32 m_GestureID;
 	
@@ -183,6 +183,11 @@ namespace star
 			return;
 		}
 
+		if(!m_GarbageList.empty())
+		{
+			//The pending frame can still point to the tile chunks of these scenes
+			SpriteBatch::GetInstance()->DiscardPendingFrame();
+		}
 		for(auto & scene : m_GarbageList)
 		{
 			auto it = m_SceneList.find(scene->GetName());
@@ -229,6 +234,9 @@ namespace star
 		}
 		if(m_ActiveScene != nullptr)
 		{
+			//Draw the frame the render thread prepared during the update,
+			//before the scene queues the next one.
+			SpriteBatch::GetInstance()->Present();
 			m_ActiveScene->BaseDraw();
 			SpriteBatch::GetInstance()->Flush();
 			DebugDraw::GetInstance()->Flush();
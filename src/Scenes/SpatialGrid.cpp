@@ -0,0 +1,265 @@
+#include "SpatialGrid.h"
+#include "../Objects/Object.h"
+#include "../Helpers/Math.h"
+#include <algorithm>
+#include <cmath>
+
+namespace star
+{
+	SpatialGrid::Entry::Entry()
+		: pObject(nullptr)
+		, order(0)
+		, minX(0)
+		, minY(0)
+		, maxX(0)
+		, maxY(0)
+		, placement(Placement::None)
+		, bIsDirty(false)
+		, queryStamp(0)
+	{
+
+	}
+
+	SpatialGrid::SpatialGrid(float32 cellSize)
+		: m_CellSize(cellSize)
+		, m_NextOrder(0)
+		, m_QueryStamp(0)
+		, m_Entries()
+		, m_Cells()
+		, m_AlwaysEntries()
+		, m_DirtyEntries()
+		, m_Candidates()
+	{
+
+	}
+
+	SpatialGrid::~SpatialGrid()
+	{
+
+	}
+
+	void SpatialGrid::Add(Object * pObject)
+	{
+		//Entries never move in the map, so the cells can point to them
+		Entry & entry = m_Entries[pObject];
+		entry.pObject = pObject;
+		entry.order = m_NextOrder++;
+		MarkDirty(pObject);
+	}
+
+	void SpatialGrid::Remove(Object * pObject)
+	{
+		auto it = m_Entries.find(pObject);
+		if(it == m_Entries.end())
+		{
+			return;
+		}
+
+		Entry * pEntry = &it->second;
+		Erase(*pEntry);
+		if(pEntry->bIsDirty)
+		{
+			m_DirtyEntries.erase(
+				std::find(m_DirtyEntries.begin(), m_DirtyEntries.end(), pEntry));
+		}
+		m_Entries.erase(it);
+	}
+
+	void SpatialGrid::MarkDirty(Object * pObject)
+	{
+		auto it = m_Entries.find(pObject);
+		if(it != m_Entries.end() && !it->second.bIsDirty)
+		{
+			it->second.bIsDirty = true;
+			m_DirtyEntries.push_back(&it->second);
+		}
+	}
+
+	void SpatialGrid::Update()
+	{
+		for(Entry * pEntry : m_DirtyEntries)
+		{
+			Erase(*pEntry);
+			Insert(*pEntry);
+			pEntry->bIsDirty = false;
+		}
+		m_DirtyEntries.clear();
+	}
+
+	void SpatialGrid::Clear()
+	{
+		m_Entries.clear();
+		m_Cells.clear();
+		m_AlwaysEntries.clear();
+		m_DirtyEntries.clear();
+		m_NextOrder = 0;
+	}
+
+	void SpatialGrid::Query(float32 left, float32 right, float32 top, float32 bottom,
+		std::vector<Object*> & result)
+	{
+		++m_QueryStamp;
+		m_Candidates.clear();
+
+		for(Entry * pEntry : m_AlwaysEntries)
+		{
+			AddCandidate(pEntry, m_Candidates);
+		}
+
+		int32 minX(GetCell(left)), maxX(GetCell(right)),
+			  minY(GetCell(bottom)), maxY(GetCell(top));
+		float64 cellAmount = (float64(maxX) - minX + 1) * (float64(maxY) - minY + 1);
+		if(cellAmount > float64(m_Entries.size()))
+		{
+			//The camera sees more cells than there are objects,
+			//so checking all objects is cheaper than walking the cells.
+			for(auto & it : m_Entries)
+			{
+				Entry & entry = it.second;
+				if(entry.placement == Placement::Cells
+					&& entry.minX <= maxX && entry.maxX >= minX
+					&& entry.minY <= maxY && entry.maxY >= minY)
+				{
+					AddCandidate(&entry, m_Candidates);
+				}
+			}
+		}
+		else
+		{
+			for(int32 y = minY; y <= maxY; ++y)
+			{
+				for(int32 x = minX; x <= maxX; ++x)
+				{
+					auto cell = m_Cells.find(GetCellKey(x, y));
+					if(cell != m_Cells.end())
+					{
+						for(Entry * pEntry : cell->second)
+						{
+							AddCandidate(pEntry, m_Candidates);
+						}
+					}
+				}
+			}
+		}
+
+		//Keep the draw order the scene had without the grid
+		std::sort(m_Candidates.begin(), m_Candidates.end(),
+			[](const Entry * a, const Entry * b) -> bool
+		{
+			return a->order < b->order;
+		});
+
+		result.reserve(result.size() + m_Candidates.size());
+		for(Entry * pEntry : m_Candidates)
+		{
+			result.push_back(pEntry->pObject);
+		}
+	}
+
+	void SpatialGrid::SetCellSize(float32 cellSize)
+	{
+		if(cellSize <= 0 || cellSize == m_CellSize)
+		{
+			return;
+		}
+		m_CellSize = cellSize;
+		for(auto & it : m_Entries)
+		{
+			MarkDirty(it.second.pObject);
+		}
+	}
+
+	float32 SpatialGrid::GetCellSize() const
+	{
+		return m_CellSize;
+	}
+
+	void SpatialGrid::Insert(Entry & entry)
+	{
+		vec4 bounds;
+		switch(entry.pObject->GetCullingBounds(bounds))
+		{
+		case CullingBoundsType::None:
+			entry.placement = Placement::None;
+			return;
+		case CullingBoundsType::Unbounded:
+			entry.placement = Placement::Always;
+			break;
+		case CullingBoundsType::Bounds:
+			entry.minX = GetCell(bounds.x);
+			entry.minY = GetCell(bounds.y);
+			entry.maxX = GetCell(bounds.z);
+			entry.maxY = GetCell(bounds.w);
+			entry.placement = 
+				(float64(entry.maxX) - entry.minX + 1) * 
+				(float64(entry.maxY) - entry.minY + 1) > MAX_CELLS_PER_OBJECT
+				? Placement::Always : Placement::Cells;
+			break;
+		}
+
+		if(entry.placement == Placement::Always)
+		{
+			m_AlwaysEntries.push_back(&entry);
+			return;
+		}
+
+		for(int32 y = entry.minY; y <= entry.maxY; ++y)
+		{
+			for(int32 x = entry.minX; x <= entry.maxX; ++x)
+			{
+				m_Cells[GetCellKey(x, y)].push_back(&entry);
+			}
+		}
+	}
+
+	void SpatialGrid::Erase(Entry & entry)
+	{
+		if(entry.placement == Placement::Always)
+		{
+			auto it = std::find(m_AlwaysEntries.begin(), m_AlwaysEntries.end(), &entry);
+			*it = m_AlwaysEntries.back();
+			m_AlwaysEntries.pop_back();
+		}
+		else if(entry.placement == Placement::Cells)
+		{
+			for(int32 y = entry.minY; y <= entry.maxY; ++y)
+			{
+				for(int32 x = entry.minX; x <= entry.maxX; ++x)
+				{
+					auto cell = m_Cells.find(GetCellKey(x, y));
+					std::vector<Entry*> & entries = cell->second;
+					auto it = std::find(entries.begin(), entries.end(), &entry);
+					*it = entries.back();
+					entries.pop_back();
+					if(entries.empty())
+					{
+						m_Cells.erase(cell);
+					}
+				}
+			}
+		}
+		entry.placement = Placement::None;
+	}
+
+	void SpatialGrid::AddCandidate(Entry * pEntry, std::vector<Entry*> & candidates)
+	{
+		//Objects spanning multiple cells are only added once
+		if(pEntry->queryStamp != m_QueryStamp)
+		{
+			pEntry->queryStamp = m_QueryStamp;
+			candidates.push_back(pEntry);
+		}
+	}
+
+	int32 SpatialGrid::GetCell(float32 coordinate) const
+	{
+		//Clamped, so huge bounds end up as oversized instead of overflowing
+		float32 cell = std::floor(coordinate / m_CellSize);
+		return int32(Clamp(cell, -1000000.0f, 1000000.0f));
+	}
+
+	uint64 SpatialGrid::GetCellKey(int32 x, int32 y)
+	{
+		return (uint64(uint32(x)) << 32) | uint64(uint32(y));
+	}
+}
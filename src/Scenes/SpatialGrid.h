@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../defines.h"
+#include <vector>
+#include <unordered_map>
+
+namespace star
+{
+	class Object;
+
+	//[NOTE]	Uniform grid over the world bounds of the top level objects
+	//			of a scene, used to find the objects near the camera.
+	//			An object is only re-inserted after it was marked dirty,
+	//			its bounds cover the object and all of its children.
+	//			Objects without fixed bounds, like HUD elements, and objects
+	//			covering too many cells are returned by every query.
+	class SpatialGrid final
+	{
+	public:
+		static const uint32 MAX_CELLS_PER_OBJECT = 64;
+
+		explicit SpatialGrid(float32 cellSize);
+		~SpatialGrid();
+
+		void Add(Object * pObject);
+		void Remove(Object * pObject);
+		void MarkDirty(Object * pObject);
+		//Recalculates the bounds of all dirty objects
+		void Update();
+		void Clear();
+
+		//Appends the objects whose bounds overlap the rectangle,
+		//in the order they were added to the grid.
+		void Query(float32 left, float32 right, float32 top, float32 bottom,
+			std::vector<Object*> & result);
+
+		void SetCellSize(float32 cellSize);
+		float32 GetCellSize() const;
+
+	private:
+		enum class Placement : byte
+		{
+			None,
+			Cells,
+			Always
+		};
+
+		struct Entry
+		{
+			Entry();
+
+			Object * pObject;
+			uint32 order;
+			int32 minX, minY, maxX, maxY;
+			Placement placement;
+			bool bIsDirty;
+			uint32 queryStamp;
+		};
+
+		void Insert(Entry & entry);
+		void Erase(Entry & entry);
+		void AddCandidate(Entry * pEntry, std::vector<Entry*> & candidates);
+		int32 GetCell(float32 coordinate) const;
+		static uint64 GetCellKey(int32 x, int32 y);
+
+		float32 m_CellSize;
+		uint32 m_NextOrder;
+		uint32 m_QueryStamp;
+		std::unordered_map<const Object*, Entry> m_Entries;
+		std::unordered_map<uint64, std::vector<Entry*>> m_Cells;
+		std::vector<Entry*> m_AlwaysEntries;
+		std::vector<Entry*> m_DirtyEntries;
+		//Scratch buffer of Query, kept to avoid reallocations
+		std::vector<Entry*> m_Candidates;
+
+		SpatialGrid(const SpatialGrid& yRef);
+		SpatialGrid(SpatialGrid&& yRef);
+		SpatialGrid& operator=(const SpatialGrid& yRef);
+		SpatialGrid& operator=(SpatialGrid&& yRef);
+	};
+}
@@ -4,8 +4,15 @@
 #include "../Helpers/Helpers.h"
 #include "../Objects/Object.h"
 #include "../Objects/FreeCamera.h"
+#ifdef STARENGINE_BENCHMARKS
+#include "../Helpers/Stopwatch.h"
+#endif
 
 #include "../Components/Graphics/SpriteComponent.h"
+#include "../Graphics/TileLayer.h"
+#include "../Graphics/TextureManager.h"
+#include <zlib.h>
+#include <algorithm>
 
 namespace star
 {
@@ -19,6 +26,7 @@ namespace star
 		, m_TileHeight(0)
 		, m_TileSets()
 		, m_TiledObjects()
+		, m_TileLayers()
 		, m_Scale(scale)
 	{
 
@@ -26,6 +34,10 @@ namespace star
 
 	TiledScene::~TiledScene()
 	{
+		for(auto layer : m_TileLayers)
+		{
+			delete layer;
+		}
 	}
 
 	void TiledScene::RemoveObject(Object * object)
@@ -39,6 +51,19 @@ namespace star
 		BaseScene::RemoveObject(object);
 	}
 
+	uint32 TiledScene::GetTileLayerCount() const
+	{
+		return m_TileLayers.size();
+	}
+
+	TileLayer * TiledScene::GetTileLayer(uint32 index) const
+	{
+		ASSERT_LOG(index < m_TileLayers.size(),
+			_T("TiledScene::GetTileLayer: Index out of range."),
+			STARENGINE_LOG_TAG);
+		return m_TileLayers[index];
+	}
+
 	void TiledScene::DefineSpecialObject(
 		const tstring & object_id,
 		const std::function<Object*(const TileObject&)> & func)
@@ -165,6 +190,26 @@ namespace star
 
 	}
 
+	void TiledScene::DrawLayers()
+	{
+		if(IsCullingEnabled())
+		{
+			float32 left, right, top, bottom;
+			GetCullingBounds(left, right, top, bottom);
+			for(auto layer : m_TileLayers)
+			{
+				layer->Draw(left, right, top, bottom);
+			}
+		}
+		else
+		{
+			for(auto layer : m_TileLayers)
+			{
+				layer->Draw();
+			}
+		}
+	}
+
 	void TiledScene::CreateLevel(const tstring & file,
 		DirectoryMode mode)
 	{
@@ -221,12 +266,31 @@ namespace star
 			set.width = string_cast<uint32>(imageAttributes[_T("width")]);
 			set.height = string_cast<uint32>(imageAttributes[_T("height")]);
 
+			TextureManager::GetInstance()->LoadTexture(
+				FilePath(set.texture).GetFullPath(),
+				GetSpritesheetName(set)
+				);
+
 			m_TileSets.push_back(set);
 
 			++TST;
 		} while(TST != TSET);
 
+#ifdef STARENGINE_BENCHMARKS
+		Stopwatch stopwatch;
+		stopwatch.Start();
+		uint32 tileAmount = CreateTiledObjects(container);
+		stopwatch.Stop();
+
+		float64 seconds = stopwatch.GetTime().GetSeconds();
+		LOG(LogLevel::Info,
+			_T("TiledScene::BaseCreateLevel: Loaded ") + string_cast<tstring>(tileAmount) +
+			_T(" tiles in ") + string_cast<tstring>(seconds * 1000.0) + _T(" ms (") +
+			string_cast<tstring>(seconds > 0 ? uint32(tileAmount / seconds) : 0) +
+			_T(" tiles/s)."), STARENGINE_LOG_TAG);
+#else
 		CreateTiledObjects(container);
+#endif
 
 		CreateGroupedObjects(container);
 	}
@@ -238,21 +302,46 @@ namespace star
 			RemoveObject(obj);
 		}
 		m_TiledObjects.clear();
+
+		for(auto layer : m_TileLayers)
+		{
+			delete layer;
+		}
+		m_TileLayers.clear();
 	}
 
-	void TiledScene::CreateTiledObjects(XMLContainer & container)
+	uint32 TiledScene::ParseGid(const tstring & value)
+	{
+		//Gids are plain unsigned decimals, this is a lot cheaper than
+		//a string_cast and doesn't overflow on the flip flags in the top bits.
+		//The flags are stripped by the callers.
+		uint32 gid(0);
+		for(auto character : value)
+		{
+			if(character < _T('0') || character > _T('9'))
+			{
+				break;
+			}
+			gid = gid * 10 + uint32(character - _T('0'));
+		}
+		return gid;
+	}
+
+	uint32 TiledScene::CreateTiledObjects(XMLContainer & container)
 	{
 		auto objectIterator = container.lower_bound(_T("layer"));
 		auto objectsEnd = container.upper_bound(_T("layer"));
 
-		tstring tsName = GetName() + _T("_tileset_default");
+		m_TileLayers.reserve(m_TileLayers.size() + container.count(_T("layer")));
+
+		//Objects for extended tiles are added in one go at the end
+		std::vector<Object*> tileObjects;
+		std::vector<uint32> gids;
+		uint32 tileAmount(0);
 
 		int32 height(0);
 		while (objectIterator != objectsEnd)
 		{
-			auto tilesIterator = objectIterator->second->at(_T("data"))->lower_bound(_T("tile"));
-			auto tilesEnd = objectIterator->second->at(_T("data"))->upper_bound(_T("tile"));
-
 			auto layerProperties = objectIterator->second->at(_T("properties"));
 			auto layerProperteriesIterator = layerProperties->lower_bound(_T("property"));
 			auto layerPropertiesEnd = layerProperties->upper_bound(_T("property"));
@@ -261,7 +350,7 @@ namespace star
 				STARENGINE_LOG_TAG);
 			do
 			{
-				auto attributes = layerProperteriesIterator->second->GetAttributes();
+				auto & attributes = layerProperteriesIterator->second->GetAttributes();
 				auto name = attributes.at(_T("name"));
 				if(name == _T("height"))
 				{
@@ -273,54 +362,281 @@ namespace star
 			float32 sX(m_Scale * m_TileWidth);
 			float32 sY(m_Scale * m_TileHeight);
 
-			uint32 i = 0;
-			while(tilesIterator != tilesEnd)
+			//Plain tiles are stored in a chunked TileLayer,
+			//only extended tiles get a full Object.
+			TileLayer * layer = new TileLayer(m_Width, m_Height, vec2(sX, sY), lay(height));
+			for(const TileSet & set : m_TileSets)
+			{
+				layer->AddTileSet(
+					set.firstGid,
+					GetSpritesheetName(set),
+					set.width / set.tileWidth,
+					set.height / set.tileHeight,
+					vec2(set.tileWidth * m_Scale, set.tileHeight * m_Scale)
+					);
+			}
+
+			if(!ReadLayerGids(*objectIterator->second->at(_T("data")), gids))
+			{
+				delete layer;
+				++objectIterator;
+				continue;
+			}
+
+			for(uint32 i = 0; i < gids.size(); ++i)
 			{
-				uint32 tID = string_cast<int32>(tilesIterator->second->GetAttributes().at(_T("gid")));
+				uint32 tID = gids[i];
 				if(tID != 0)
 				{
-					TileSet tileSet;
+					if(m_ExtensionTiles.find(tID) == m_ExtensionTiles.end())
+					{
+						layer->SetTile(i % m_Width, i / m_Width, tID);
+					}
+					else
+					{
+						TileSet tileSet;
+
+						GetCorrectTileset(tID, tileSet);
+
+						Object * obj = new Object();
+						auto transform = obj->GetTransform();
+						float32 x((i % m_Width) * sX);
+						float32 y((m_Height - (i / m_Width) - 1) * sY);
+					#ifdef STAR2D
+						// [TODO] Use height from layer name instead of this hack
+						transform->Translate(
+							x,
+							y,
+							height
+							);
+						transform->Scale(m_Scale, m_Scale);
+					#else
+						transform->Translate(
+							x,
+							y,
+							height * m_Scale
+							);
+						transform->Scale(m_Scale, m_Scale, m_Scale);
+					#endif
+
+						auto texture = CreateSpriteFromGid(tID, tileSet);
+						obj->AddComponent(texture);
 
-					GetCorrectTileset(tID, tileSet);
+						m_ExtensionTiles[tID](obj);
+						tileObjects.push_back(obj);
+					}
+				}
+			}
+			tileAmount += gids.size();
+			m_TileLayers.push_back(layer);
+			++objectIterator;
+		}
 
-					Object * obj = new Object();
-					auto transform = obj->GetTransform();
-					float32 x((i % m_Width) * sX);
-					float32 y((m_Height - (i / m_Width) - 1) * sY);
-				#ifdef STAR2D
-					// [TODO] Use height from layer name instead of this hack
-					transform->Translate(
-						x,
-						y,
-						height
-						);
-					transform->Scale(m_Scale, m_Scale);
-				#else
-					transform->Translate(
-						x,
-						y,
-						height * m_Scale
-						);
-					transform->Scale(m_Scale, m_Scale, m_Scale);
-				#endif
+		AddObjects(tileObjects);
+		m_TiledObjects.insert(m_TiledObjects.end(), tileObjects.begin(), tileObjects.end());
+		return tileAmount;
+	}
 
-					auto texture = CreateSpriteFromGid(tID, tileSet);
-					obj->AddComponent(texture);
+	bool TiledScene::ReadLayerGids(XMLContainer & data, std::vector<uint32> & gids) const
+	{
+		gids.clear();
+		gids.reserve(m_Width * m_Height);
 
-					if(m_ExtensionTiles.find(tID) != m_ExtensionTiles.end())
+		auto & attributes = data.GetAttributes();
+		auto encodingIt = attributes.find(_T("encoding"));
+		if(encodingIt == attributes.end())
+		{
+			//Plain XML, one <tile gid="..."/> element per tile
+			const tstring gidKey(_T("gid"));
+			auto tilesIterator = data.lower_bound(_T("tile"));
+			auto tilesEnd = data.upper_bound(_T("tile"));
+			for(; tilesIterator != tilesEnd; ++tilesIterator)
+			{
+				gids.push_back(ParseGid(tilesIterator->second->GetAttributes().at(gidKey)));
+			}
+		}
+		else
+		{
+			auto compressionIt = attributes.find(_T("compression"));
+			bool isCompressed(compressionIt != attributes.end());
+
+			if(encodingIt->second == _T("csv") && !isCompressed)
+			{
+				DecodeCSV(data.GetValue(), gids);
+			}
+			else if(encodingIt->second == _T("base64"))
+			{
+				std::vector<uint8> bytes;
+				DecodeBase64(data.GetValue(), bytes);
+				if(isCompressed)
+				{
+					//zlib and gzip streams are both handled by Inflate
+					std::vector<uint8> inflated;
+					if((compressionIt->second != _T("zlib") && compressionIt->second != _T("gzip"))
+						|| !Inflate(bytes, inflated, m_Width * m_Height * 4))
 					{
-						m_ExtensionTiles[tID](obj);
+						LOG(LogLevel::Error,
+							_T("TiledScene::ReadLayerGids: Couldn't decompress '")
+							+ compressionIt->second + _T("' layer data."),
+							STARENGINE_LOG_TAG);
+						return false;
 					}
-					obj->SetName(_T("tile_") + string_cast<tstring>(height) +
-						_T("_") + string_cast<tstring>(i));
-					AddObject(obj);
-					m_TiledObjects.push_back(obj);
+					bytes.swap(inflated);
+				}
+
+				//Gids are stored as little endian uint32
+				gids.resize(bytes.size() / 4);
+				for(uint32 i = 0; i < gids.size(); ++i)
+				{
+					const uint8 * gid = &bytes[i * 4];
+					gids[i] = uint32(gid[0])
+						| (uint32(gid[1]) << 8)
+						| (uint32(gid[2]) << 16)
+						| (uint32(gid[3]) << 24);
 				}
-				++i;
-				++tilesIterator;
 			}
-			++objectIterator;
+			else
+			{
+				LOG(LogLevel::Error,
+					_T("TiledScene::ReadLayerGids: Unsupported layer encoding '")
+					+ encodingIt->second + (isCompressed ? _T("+") + compressionIt->second : tstring())
+					+ _T("'."), STARENGINE_LOG_TAG);
+				return false;
+			}
+		}
+
+		//Flipped tiles aren't supported by the TileLayer, they're drawn unflipped.
+		//Without the flags the gid points to the right tileset again.
+		uint32 flippedAmount(0);
+		for(uint32 & gid : gids)
+		{
+			if((gid & GID_FLIP_FLAGS) != 0)
+			{
+				gid &= GID_MASK;
+				++flippedAmount;
+			}
 		}
+		if(flippedAmount > 0)
+		{
+			LOG(LogLevel::Warning,
+				_T("TiledScene::ReadLayerGids: Layer has ") + string_cast<tstring>(flippedAmount) +
+				_T(" flipped tiles, they are drawn without flipping."),
+				STARENGINE_LOG_TAG);
+		}
+
+		if(gids.size() != m_Width * m_Height)
+		{
+			LOG(LogLevel::Warning,
+				_T("TiledScene::ReadLayerGids: Layer has ") + string_cast<tstring>(gids.size()) +
+				_T(" tiles, expected ") + string_cast<tstring>(m_Width * m_Height) + _T("."),
+				STARENGINE_LOG_TAG);
+			gids.resize(m_Width * m_Height, 0);
+		}
+		return true;
+	}
+
+	void TiledScene::DecodeCSV(const tstring & value, std::vector<uint32> & gids)
+	{
+		//Comma separated gids, with line breaks between the rows
+		uint32 gid(0);
+		bool hasDigits(false);
+		for(auto character : value)
+		{
+			if(character >= _T('0') && character <= _T('9'))
+			{
+				gid = gid * 10 + uint32(character - _T('0'));
+				hasDigits = true;
+			}
+			else if(character == _T(','))
+			{
+				gids.push_back(gid);
+				gid = 0;
+				hasDigits = false;
+			}
+		}
+		if(hasDigits)
+		{
+			gids.push_back(gid);
+		}
+	}
+
+	void TiledScene::DecodeBase64(const tstring & value, std::vector<uint8> & bytes)
+	{
+		bytes.reserve(value.size() * 3 / 4);
+		uint32 buffer(0), bits(0);
+		for(auto character : value)
+		{
+			uint32 digit;
+			if(character >= _T('A') && character <= _T('Z'))
+			{
+				digit = uint32(character - _T('A'));
+			}
+			else if(character >= _T('a') && character <= _T('z'))
+			{
+				digit = uint32(character - _T('a')) + 26;
+			}
+			else if(character >= _T('0') && character <= _T('9'))
+			{
+				digit = uint32(character - _T('0')) + 52;
+			}
+			else if(character == _T('+'))
+			{
+				digit = 62;
+			}
+			else if(character == _T('/'))
+			{
+				digit = 63;
+			}
+			else
+			{
+				//Whitespace and '=' padding
+				continue;
+			}
+
+			buffer = (buffer << 6) | digit;
+			bits += 6;
+			if(bits >= 8)
+			{
+				bits -= 8;
+				bytes.push_back(uint8(buffer >> bits));
+			}
+		}
+	}
+
+	bool TiledScene::Inflate(const std::vector<uint8> & source,
+		std::vector<uint8> & destination, uint32 expectedSize)
+	{
+		if(source.empty())
+		{
+			return false;
+		}
+
+		z_stream stream = {};
+		stream.next_in = const_cast<Bytef*>(&source[0]);
+		stream.avail_in = uInt(source.size());
+
+		//15 + 32 detects both zlib and gzip headers
+		if(inflateInit2(&stream, 15 + 32) != Z_OK)
+		{
+			return false;
+		}
+
+		destination.resize(std::max<uint32>(expectedSize, 1));
+		int32 result(Z_OK);
+		while(result == Z_OK)
+		{
+			if(stream.total_out == destination.size())
+			{
+				destination.resize(destination.size() * 2);
+			}
+			stream.next_out = &destination[stream.total_out];
+			stream.avail_out = uInt(destination.size() - stream.total_out);
+			result = inflate(&stream, Z_NO_FLUSH);
+		}
+
+		destination.resize(stream.total_out);
+		inflateEnd(&stream);
+		return result == Z_STREAM_END;
 	}
 
 	void TiledScene::CreateGroupedObjects(XMLContainer & container)
@@ -362,7 +678,8 @@ Make sure to define all necacary properties!"),
 				const auto objectGlobalIDIterator = objAttributes.lower_bound(_T("gid"));
 				if(objectGlobalIDIterator != objAttributes.end())
 				{
-					tObj.id = string_cast<int32>(objectGlobalIDIterator->second);
+					//Tile objects can be flipped as well
+					tObj.id = int32(ParseGid(objectGlobalIDIterator->second) & GID_MASK);
 				}
 
 				const auto rX = objAttributes.lower_bound(_T("x"));
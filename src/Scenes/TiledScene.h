@@ -8,6 +8,7 @@ namespace star
 {
 	class XMLContainer;
 	class SpriteComponent;
+	class TileLayer;
 
 	class TiledScene : public BaseScene
 	{
@@ -31,6 +32,9 @@ namespace star
 		virtual ~TiledScene();
 
 		virtual void RemoveObject(Object * object);
+
+		uint32 GetTileLayerCount() const;
+		TileLayer * GetTileLayer(uint32 index) const;
 	protected:
 
 		virtual void CreateObjects();
@@ -65,13 +69,26 @@ namespace star
 		float32 m_Scale;
 		std::vector<TileSet> m_TileSets;
 		std::vector<Object*> m_TiledObjects;
+		std::vector<TileLayer*> m_TileLayers;
 		std::map<tstring, std::function<Object*(const TileObject&)>> m_DefinedObject;
 		std::map<uint32, std::function<void(Object*)>> m_ExtensionTiles;
 
 	private:
-		void CreateTiledObjects(XMLContainer & container);
+		//Draws the tile layers, not overridable so they can't get lost
+		void DrawLayers() final;
+		uint32 CreateTiledObjects(XMLContainer & container);
+		static uint32 ParseGid(const tstring & value);
+		bool ReadLayerGids(XMLContainer & data, std::vector<uint32> & gids) const;
+		static void DecodeCSV(const tstring & value, std::vector<uint32> & gids);
+		static void DecodeBase64(const tstring & value, std::vector<uint8> & bytes);
+		static bool Inflate(const std::vector<uint8> & source,
+			std::vector<uint8> & destination, uint32 expectedSize);
 		void CreateGroupedObjects(XMLContainer & container);
 
+		//Tiled stores horizontal, vertical and diagonal flipping in the top 3 bits
+		static const uint32 GID_FLIP_FLAGS = 0xE0000000;
+		static const uint32 GID_MASK = 0x1FFFFFFF;
+
 		TiledScene(const TiledScene& t);
 		TiledScene(TiledScene&& t);
 		TiledScene& operator=(const TiledScene& t);
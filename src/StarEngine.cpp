@@ -2,6 +2,7 @@
 #include "Graphics/GraphicsManager.h"
 #include "Graphics/SpriteAnimationManager.h"
 #include "Graphics/SpriteBatch.h"
+#include "Graphics/GLStateCache.h"
 #include "Graphics/FontManager.h"
 #include "Graphics/ScaleSystem.h"
 #include "Scenes/SceneManager.h"
@@ -52,19 +53,34 @@ namespace star
 	void StarEngine::Update(const Context & context)
 	{
 		m_FPS.Update(context);
-		SceneManager::GetInstance()->Update(context);
+
+		//With a fixed timestep this can be several steps, or none at all
+		uint32 steps = context.time->ScheduleSteps();
+		for(uint32 i = 0; i < steps; ++i)
+		{
+			context.time->StartStep();
+#ifdef DESKTOP
+			//Polled per step, so a key press only triggers once
+			InputManager::GetInstance()->UpdateWin();
+#endif
+			SceneManager::GetInstance()->Update(context);
+			InputManager::GetInstance()->EndUpdate();
+		}
 		GraphicsManager::GetInstance()->Update();
-		InputManager::GetInstance()->EndUpdate();
 		Logger::GetInstance()->Update(context);
 #if defined(DEBUG) | defined(_DEBUG)
 		OPENGL_LOG();
 #endif
-		m_bInitialized = true;
+		if(steps > 0)
+		{
+			m_bInitialized = true;
+		}
 	}
 
 	void StarEngine::Draw()
 	{
 		GraphicsManager::GetInstance()->StartDraw();
+		TextureManager::GetInstance()->UploadDecodedTextures();
 		if(m_bInitialized)
 		{
 			SceneManager::GetInstance()->Draw();
@@ -85,6 +101,7 @@ namespace star
 		AudioManager::DeleteSingleton();
 		PathFindManager::DeleteSingleton();
 		SceneManager::DeleteSingleton();
+		GLStateCache::DeleteSingleton();
 		Logger::DeleteSingleton();
 		TimeManager::DeleteSingleton();
 	}
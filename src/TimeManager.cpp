@@ -1,6 +1,7 @@
 #include "TimeManager.h"
 #include "Logger.h"
 #include "Helpers\Helpers.h"
+#include <algorithm>
 
 namespace star
 {
@@ -8,10 +9,19 @@ namespace star
 		: Singleton<TimeManager>()
 		, m_StartTime()
 		, m_DeltaTime()
+		, m_FrameTime()
 		, m_ElapsedTime()
 		, m_CurrentTime()
+		, m_LastScheduleTime()
+		, m_FixedTimeStep()
+		, m_Accumulator()
+		, m_MaxStepsPerFrame(DEFAULT_MAX_STEPS)
+		, m_StepCount(0)
+		, m_InterpolationAlpha(1.0f)
+		, m_bUseFixedTimeStep(false)
+		, m_bResetAccumulator(true)
 	{
-
+		SetFixedTimeStep(1.0 / 60.0);
 	}
 
 	TimeManager::~TimeManager()
@@ -24,6 +34,11 @@ namespace star
 		return m_DeltaTime;
 	}
 
+	const Time & TimeManager::FrameTime()
+	{
+		return m_FrameTime;
+	}
+
 	const Time & TimeManager::TimeSinceStart()
 	{
 		return m_ElapsedTime;
@@ -44,8 +59,119 @@ namespace star
 	void TimeManager::StopMonitoring()
 	{
 		auto endTime = std::chrono::high_resolution_clock::now();
-		m_DeltaTime.m_TimeDuration = endTime - m_StartTime;
-		m_ElapsedTime += m_DeltaTime;
+		m_FrameTime.m_TimeDuration = endTime - m_StartTime;
+		m_ElapsedTime += m_FrameTime;
+		if(!m_bUseFixedTimeStep)
+		{
+			m_DeltaTime = m_FrameTime;
+		}
+	}
+
+	void TimeManager::SetFixedTimeStepEnabled(bool enable)
+	{
+		if(enable && !m_bUseFixedTimeStep)
+		{
+			m_bResetAccumulator = true;
+		}
+		m_bUseFixedTimeStep = enable;
+		m_DeltaTime = enable ? m_FixedTimeStep : m_FrameTime;
+	}
+
+	bool TimeManager::IsFixedTimeStepEnabled() const
+	{
+		return m_bUseFixedTimeStep;
+	}
+
+	void TimeManager::SetFixedTimeStep(float64 seconds)
+	{
+		if(seconds <= 0.0)
+		{
+			LOG(LogLevel::Warning,
+				_T("TimeManager::SetFixedTimeStep: The timestep has to be positive."),
+				STARENGINE_LOG_TAG);
+			return;
+		}
+		m_FixedTimeStep.m_TimeDuration =
+			std::chrono::duration_cast<std::chrono::system_clock::duration>(
+				std::chrono::duration<float64>(seconds));
+		if(m_bUseFixedTimeStep)
+		{
+			m_DeltaTime = m_FixedTimeStep;
+		}
+	}
+
+	float64 TimeManager::GetFixedTimeStep() const
+	{
+		return m_FixedTimeStep.GetSeconds();
+	}
+
+	void TimeManager::SetMaxStepsPerFrame(uint32 steps)
+	{
+		m_MaxStepsPerFrame = std::max<uint32>(steps, 1);
+	}
+
+	uint32 TimeManager::GetMaxStepsPerFrame() const
+	{
+		return m_MaxStepsPerFrame;
+	}
+
+	uint32 TimeManager::ScheduleSteps()
+	{
+		if(!m_bUseFixedTimeStep)
+		{
+			m_InterpolationAlpha = 1.0f;
+			return 1;
+		}
+
+		//Measured from schedule to schedule, so nothing
+		//the platform loop does in between gets lost.
+		auto now = std::chrono::high_resolution_clock::now();
+		if(m_bResetAccumulator)
+		{
+			//Start with one step, so there's something to draw
+			m_Accumulator = m_FixedTimeStep;
+			m_bResetAccumulator = false;
+		}
+		else
+		{
+			m_Accumulator.m_TimeDuration += now - m_LastScheduleTime;
+		}
+		m_LastScheduleTime = now;
+
+		uint32 steps(0);
+		while(m_Accumulator.m_TimeDuration >= m_FixedTimeStep.m_TimeDuration
+			&& steps < m_MaxStepsPerFrame)
+		{
+			m_Accumulator -= m_FixedTimeStep;
+			++steps;
+		}
+
+		//Spiral of death, the game can't keep up with the timestep.
+		//Drop the time that is left instead of catching up later.
+		if(m_Accumulator.m_TimeDuration >= m_FixedTimeStep.m_TimeDuration)
+		{
+			m_Accumulator %= m_FixedTimeStep;
+		}
+
+		m_InterpolationAlpha = float32(
+			m_Accumulator.GetSeconds() / m_FixedTimeStep.GetSeconds());
+		m_DeltaTime = m_FixedTimeStep;
+		return steps;
+	}
+
+	void TimeManager::StartStep()
+	{
+		++m_StepCount;
+	}
+
+	uint64 TimeManager::GetStepCount() const
+	{
+		return m_StepCount;
+	}
+
+	float32 TimeManager::GetInterpolationAlpha() const
+	{
+		return m_InterpolationAlpha;
 	}
 
 	tstring TimeManager::GetTimeStamp()
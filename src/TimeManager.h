@@ -17,7 +17,31 @@ namespace star
 		void StartMonitoring();
 		void StopMonitoring();
 
+		//[NOTE]	With a fixed timestep the game updates in steps of
+		//			a constant duration, as many as the elapsed time allows.
+		//			DeltaTime returns the step duration in that case.
+		//			Disabled by default, every frame is one step of the
+		//			measured frame time then.
+		void SetFixedTimeStepEnabled(bool enable);
+		bool IsFixedTimeStepEnabled() const;
+		void SetFixedTimeStep(float64 seconds);
+		float64 GetFixedTimeStep() const;
+		//Steps that don't fit in a frame are dropped,
+		//so a slow frame can't make the next one even slower.
+		void SetMaxStepsPerFrame(uint32 steps);
+		uint32 GetMaxStepsPerFrame() const;
+
+		//Called once per frame, returns the amount of steps to update
+		uint32 ScheduleSteps();
+		void StartStep();
+		//Amount of steps started since the start
+		uint64 GetStepCount() const;
+		//How far the frame is between the previous and the last step, 0 to 1
+		float32 GetInterpolationAlpha() const;
+
 		const Time & DeltaTime();
+		//The measured duration of the last frame, also with a fixed timestep
+		const Time & FrameTime();
 		const Time & TimeSinceStart();
 		const Time & CurrentTime();
 
@@ -27,11 +51,23 @@ namespace star
 		TimeManager();
 		~TimeManager();
 
+		static const uint32 DEFAULT_MAX_STEPS = 5;
+
 		std::chrono::system_clock::time_point m_StartTime;
 		Time m_DeltaTime;
+		Time m_FrameTime;
 		Time m_ElapsedTime;
 		Time m_CurrentTime;
 
+		std::chrono::high_resolution_clock::time_point m_LastScheduleTime;
+		Time m_FixedTimeStep;
+		Time m_Accumulator;
+		uint32 m_MaxStepsPerFrame;
+		uint64 m_StepCount;
+		float32 m_InterpolationAlpha;
+		bool m_bUseFixedTimeStep;
+		bool m_bResetAccumulator;
+
 		TimeManager(const TimeManager& t);
 		TimeManager(TimeManager&& t);
 		TimeManager& operator=(const TimeManager& t);